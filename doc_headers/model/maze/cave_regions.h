@@ -0,0 +1,74 @@
+/**
+ * @file cave_regions.h
+ * @brief Connected regions of the open cells of a cave.
+ */
+
+#ifndef CAVE_REGIONS_H_
+#define CAVE_REGIONS_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "maze.h"
+
+/**
+ * @class CaveRegions
+ * @brief Region id per cell for the 4-connected dead cells of a cave.
+ *
+ * Labeling works on runs of open cells: each row's runs are read from the row
+ * word with bit scans, joined with the overlapping runs of the row above by
+ * union-find, and the roots are numbered in row-major order of their first
+ * cell. Queries are O(1) table lookups.
+ */
+class CaveRegions {
+ public:
+  /// Label of a live (solid) cell.
+  static constexpr uint16_t kSolid = UINT16_MAX;
+
+  /**
+   * @brief Labels the cave.
+   * @param cave Cave whose live cells are the set bits of the vertical words.
+   */
+  explicit CaveRegions(const Maze& cave);
+
+  /**
+   * @brief Whether the labels still describe a cave.
+   * @param cave Cave to compare with.
+   * @return true if its size and cells are the ones that were labeled.
+   */
+  bool Matches(const Maze& cave) const;
+
+  /// Number of regions.
+  /// @return Region count; ids are 0 to Count() - 1.
+  int Count() const { return static_cast<int>(m_sizes_.size()); }
+
+  /// Number of cells in a region.
+  /// @param region Region id.
+  /// @return Cell count.
+  int Size(int region) const { return m_sizes_[region]; }
+
+  /// Region of a cell.
+  /// @param cell Cell inside the cave.
+  /// @return Region id, or kSolid for a live cell.
+  uint16_t Region(Cell cell) const {
+    return m_labels_[cell.r * m_cols_ + cell.c];
+  }
+
+  /// Whether two cells are open and reachable from each other.
+  /// @param a First cell.
+  /// @param b Second cell.
+  /// @return true if both are in the same region.
+  bool Connected(Cell a, Cell b) const {
+    return Region(a) != kSolid && Region(a) == Region(b);
+  }
+
+ private:
+  int m_rows_;                              ///< Rows of the labeled cave.
+  int m_cols_;                              ///< Columns of the labeled cave.
+  std::array<uint64_t, kMaxSize> m_cells_;  ///< Words that were labeled.
+  std::vector<uint16_t> m_labels_;          ///< Region per cell, row-major.
+  std::vector<int> m_sizes_;                ///< Cells per region.
+};
+
+#endif  // CAVE_REGIONS_H_
@@ -0,0 +1,51 @@
+/**
+ * @file distance_map.h
+ * @brief Flat result of Maze::DistanceMatrix.
+ */
+
+#ifndef DISTANCE_MAP_H_
+#define DISTANCE_MAP_H_
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../cell.h"
+
+/**
+ * @struct DistanceMap
+ * @brief Breadth-first distances from one cell.
+ *
+ * Reachable cells are stored level by level in one array (CSR layout); level
+ * i is cells[offsets[i], offsets[i + 1]). There is no trailing empty level.
+ */
+struct DistanceMap {
+  /// Distance of cells that cannot be reached.
+  static constexpr uint32_t kUnreachable = UINT32_MAX;
+
+  int rows = 0;                    ///< Number of rows of the maze.
+  int cols = 0;                    ///< Number of columns of the maze.
+  std::vector<uint32_t> distance;  ///< Distance per cell, row-major.
+  std::vector<Cell> cells;         ///< Reachable cells ordered by distance.
+  std::vector<uint32_t> offsets;   ///< Start of each level in cells, plus end.
+
+  /// Number of non-empty levels.
+  /// @return Levels, 0 if the start was outside the maze.
+  size_t Levels() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+  /// Cells at distance @p i.
+  /// @param i Level index, less than Levels().
+  /// @return View into cells.
+  std::span<const Cell> Level(size_t i) const {
+    return {cells.data() + offsets[i], cells.data() + offsets[i + 1]};
+  }
+
+  /// Distance of a cell.
+  /// @param cell Cell inside the maze.
+  /// @return Distance or kUnreachable.
+  uint32_t Distance(Cell cell) const {
+    return distance[cell.r * cols + cell.c];
+  }
+};
+
+#endif  // DISTANCE_MAP_H_
@@ -0,0 +1,106 @@
+/**
+ * @file indexed_heap.h
+ * @brief Min-heap of cell indices with decrease-key, used by A*.
+ */
+
+#ifndef INDEXED_HEAP_H_
+#define INDEXED_HEAP_H_
+
+#include <array>
+#include <cstdint>
+
+#include "maze.h"
+
+/**
+ * @class IndexedHeap
+ * @brief Binary min-heap keyed by cell index.
+ *
+ * Each cell index (r * kMaxSize + c) is queued at most once; pushing it again
+ * lowers its key in place. Positions are never cleared: an index is queued
+ * only if the item at its stored position points back at it, so Clear() is
+ * O(1).
+ */
+class IndexedHeap {
+ public:
+  /// Number of cell indices the heap can hold.
+  static constexpr int kCells = kMaxSize * kMaxSize;
+
+  /// Creates an empty heap.
+  IndexedHeap() : m_items_(), m_positions_(), m_size_(0) {}
+
+  /// Removes every item.
+  void Clear() { m_size_ = 0; }
+
+  /// Whether the heap is empty.
+  /// @return true if there is nothing to pop.
+  bool Empty() const { return m_size_ == 0; }
+
+  /// Whether an index is queued.
+  /// @param id Cell index.
+  /// @return true if it was pushed and not popped since the last Clear.
+  bool Contains(int id) const {
+    int pos = m_positions_[id];
+    return pos < m_size_ && m_items_[pos].id == id;
+  }
+
+  /// Inserts an index or lowers its key if it is already queued.
+  /// @param id Cell index.
+  /// @param key New key; must not exceed the current one.
+  void Push(int id, uint32_t key) {
+    int pos = Contains(id) ? m_positions_[id] : m_size_++;
+    m_items_[pos] = {key, static_cast<uint16_t>(id)};
+    SiftUp(pos);
+  }
+
+  /// Removes the index with the smallest key.
+  /// @return Cell index.
+  int Pop() {
+    int top = m_items_[0].id;
+    m_items_[0] = m_items_[--m_size_];
+    m_positions_[m_items_[0].id] = 0;
+    SiftDown(0);
+    return top;
+  }
+
+ private:
+  /// Heap entry.
+  struct Item {
+    uint32_t key;  ///< Priority, smaller first.
+    uint16_t id;   ///< Cell index.
+  };
+
+  /// Moves the item at @p pos towards the root.
+  /// @param pos Heap position.
+  void SiftUp(int pos) {
+    Item item = m_items_[pos];
+    while (pos > 0 && item.key < m_items_[(pos - 1) / 2].key) {
+      m_items_[pos] = m_items_[(pos - 1) / 2];
+      m_positions_[m_items_[pos].id] = pos;
+      pos = (pos - 1) / 2;
+    }
+    m_items_[pos] = item;
+    m_positions_[item.id] = pos;
+  }
+
+  /// Moves the item at @p pos towards the leaves.
+  /// @param pos Heap position.
+  void SiftDown(int pos) {
+    Item item = m_items_[pos];
+    for (int child = 2 * pos + 1; child < m_size_; child = 2 * pos + 1) {
+      if (child + 1 < m_size_ && m_items_[child + 1].key < m_items_[child].key)
+        ++child;
+      if (m_items_[child].key >= item.key) break;
+      m_items_[pos] = m_items_[child];
+      m_positions_[m_items_[pos].id] = pos;
+      pos = child;
+    }
+    m_items_[pos] = item;
+    m_positions_[item.id] = pos;
+  }
+
+  std::array<Item, kCells> m_items_;          ///< Heap-ordered entries.
+  std::array<uint16_t, kCells> m_positions_;  ///< Heap position per index.
+  int m_size_;                                ///< Number of entries.
+};
+
+#endif  // INDEXED_HEAP_H_
@@ -9,16 +9,37 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "../cell.h"
+#include "distance_map.h"
 
 /// Maximum allowed maze size per side.
 constexpr int kMaxSize = 50;
 
+class SolverWorkspace;
+class CaveRegions;
+
+/// How SolveMaze searches for a path.
+enum class SearchMode {
+  kBreadthFirst,   ///< Expand from the start until the end is popped.
+  kBidirectional,  ///< Grow from both ends and stop when the frontiers meet.
+  kAStar,          ///< A* with the Manhattan heuristic.
+  kJumpPoint       ///< Jump point search; SolveCavePath only.
+};
+
+/// Outcome of Maze::RunCaveToStable.
+struct CaveRun {
+  int steps;   ///< Number of steps performed.
+  int period;  ///< 1 if stable, p if cycling with period p, 0 if not settled.
+};
+
 /**
  * @class Maze
  * @brief Class for working with mazes and caves.
@@ -63,16 +84,144 @@ class Maze {
   /// @return true if the cave is stabilized.
   bool SolveCave(const int birth, const int death);
 
+  /// Perform one evolution step and report which rows changed.
+  /// @param birth Birth threshold.
+  /// @param death Death threshold.
+  /// @param changed Receives a mask with bit i set if row i changed.
+  /// @return true if the cave is stabilized.
+  bool SolveCave(const int birth, const int death, uint64_t &changed);
+
+  /// Perform one evolution step counting neighbours in a square of the
+  /// given radius instead of the 3x3 Moore neighbourhood. Neighbour sums
+  /// come from a summed-area table, so the cost per cell does not depend on
+  /// the radius. Radius 1 gives the same cells as SolveCave.
+  /// @param birth Birth threshold, out of (2 * radius + 1)^2 - 1 neighbours.
+  /// @param death Death threshold.
+  /// @param radius Neighbourhood radius, 1 to kMaxSize.
+  /// @return true if the cave is stabilized.
+  /// @throws std::invalid_argument if the radius is out of range.
+  bool SolveCaveRadius(const int birth, const int death, const int radius);
+
+  /// Perform one larger-neighbourhood step and report which rows changed.
+  /// @param birth Birth threshold.
+  /// @param death Death threshold.
+  /// @param radius Neighbourhood radius, 1 to kMaxSize.
+  /// @param changed Receives a mask with bit i set if row i changed.
+  /// @return true if the cave is stabilized.
+  bool SolveCaveRadius(const int birth, const int death, const int radius,
+                       uint64_t &changed);
+
+  /// Perform up to @p steps evolution steps, stopping once the cave is stable.
+  /// @param birth Birth threshold.
+  /// @param death Death threshold.
+  /// @param steps Maximum number of steps.
+  /// @param stable Set to true if the last step changed nothing.
+  /// @return Number of steps performed.
+  int SolveCaveSteps(const int birth, const int death, const int steps,
+                     bool &stable);
+
+  /// Evolve the cave until it stops changing or repeats an earlier state.
+  /// With radius 1, rows are stepped a word at a time with bit-sliced
+  /// neighbour counts, giving the same cells as repeated SolveCave calls;
+  /// larger radii step like SolveCaveRadius. Each generation is hashed, so
+  /// a cycle of any length is caught on its first repeat.
+  /// @param birth Birth threshold.
+  /// @param death Death threshold.
+  /// @param max_steps Maximum number of steps.
+  /// @param radius Neighbourhood radius, 1 to kMaxSize.
+  /// @return Steps performed and the period of the final state.
+  /// @throws std::invalid_argument if the radius is out of range.
+  CaveRun RunCaveToStable(const int birth, const int death,
+                          const int max_steps, const int radius = 1);
+
+  /// Post-process a cave into one connected open region.
+  /// Open regions smaller than @p min_region_size are filled, except the
+  /// largest, then the remaining regions are joined greedily: each step
+  /// carves the tunnel with the fewest live cells from the connected part
+  /// to the nearest other region. Filling works on the packed row words;
+  /// tunnel carving is per cell, one full-grid search per joined region, so
+  /// it costs O(regions * rows * cols).
+  /// @param min_region_size Smallest region size to keep.
+  /// @return Number of live cells carved into tunnels.
+  int ConnectCave(int min_region_size);
+
   /// Solve the maze from start to end.
   /// @param end End cell.
   /// @param start Start cell.
+  /// @param mode Search strategy; all give paths of the same length.
   /// @return Vector of cells representing the path.
-  std::vector<Cell> SolveMaze(Cell end, Cell start);
+  /// @throws std::invalid_argument for SearchMode::kJumpPoint.
+  std::vector<Cell> SolveMaze(Cell end, Cell start,
+                              SearchMode mode = SearchMode::kBreadthFirst);
+
+  /// Solve the maze into a caller-owned buffer.
+  /// Reusing @p pass across calls avoids allocating a new path each time;
+  /// the search itself runs in a per-thread SolverWorkspace.
+  /// @param end End cell.
+  /// @param start Start cell.
+  /// @param pass Replaced with the path from end to start; cleared if there
+  /// is none.
+  /// @param mode Search strategy.
+  /// @return true if a path was found.
+  /// @throws std::invalid_argument for SearchMode::kJumpPoint.
+  bool SolveMaze(Cell end, Cell start, std::vector<Cell> &pass,
+                 SearchMode mode = SearchMode::kBreadthFirst);
+
+  /// Solve the maze using the given search state.
+  /// @param end End cell.
+  /// @param start Start cell.
+  /// @param pass Replaced with the path from end to start.
+  /// @param workspace Scratch state, reused without clearing.
+  /// @param mode Search strategy, any but SearchMode::kJumpPoint.
+  /// @return true if a path was found.
+  /// @throws std::invalid_argument for SearchMode::kJumpPoint.
+  bool SolveMaze(Cell end, Cell start, std::vector<Cell> &pass,
+                 SolverWorkspace &workspace,
+                 SearchMode mode = SearchMode::kBreadthFirst) const;
+
+  /// Solve many queries against the same maze.
+  /// Queries with the same start share one BFS tree; the trees are spread
+  /// over up to @p threads threads.
+  /// @param queries (end, start) pairs, in the argument order of SolveMaze.
+  /// @param threads Maximum number of threads to use.
+  /// @return One path per query, equal to SolveMaze(end, start); empty if
+  /// there is no path or a point is outside the maze.
+  std::vector<std::vector<Cell>> SolveMazeBatch(
+      const std::vector<std::pair<Cell, Cell>> &queries,
+      unsigned threads = 1) const;
+
+  /// Find a path through the dead cells of a cave.
+  /// Live cells in the vertical words are solid.
+  /// @param end End cell.
+  /// @param start Start cell.
+  /// @param mode kJumpPoint for jump point search, anything else for A*.
+  /// @return Shortest path from end to start; empty if there is none or an
+  /// end point is solid.
+  std::vector<Cell> SolveCavePath(
+      Cell end, Cell start, SearchMode mode = SearchMode::kJumpPoint) const;
+
+  /// Find a cave path into a caller-owned buffer.
+  /// @param end End cell.
+  /// @param start Start cell.
+  /// @param pass Replaced with the path from end to start.
+  /// @param mode kJumpPoint for jump point search, anything else for A*.
+  /// @return true if a path was found.
+  bool SolveCavePath(Cell end, Cell start, std::vector<Cell> &pass,
+                     SearchMode mode = SearchMode::kJumpPoint) const;
 
   /// Build a distance matrix from the given cell.
   /// @param start Start cell.
-  /// @return Matrix of distances.
-  std::vector<std::vector<Cell>> DistanceMatrix(Cell start);
+  /// @return Distances and cells grouped by level; empty if @p start is
+  /// outside the maze.
+  DistanceMap DistanceMatrix(Cell start) const;
+
+  /// Connected regions of the cave's open cells.
+  /// The labels are cached and rebuilt only after the cave changes, e.g. by
+  /// SolveCave. The cache is guarded, so threads may query the same const
+  /// maze; changing the cave while others read it is still a data race.
+  /// @return Labels of the cave at the time of the call; they stay valid
+  /// while held, even after the cave changes.
+  std::shared_ptr<const CaveRegions> Regions() const;
 
   /// Load a maze from a stream.
   /// @param stream Input stream.
@@ -126,11 +275,13 @@ class Maze {
   /// @return true if dimensions are valid.
   bool SetRowsCols(int rows, int cols);
 
-  /// Initialize the random number generator.
+  /// Seed the random number generator of the calling thread.
+  /// Every thread that draws from _gen must call it first; later calls on
+  /// the same thread do nothing.
   static void InitRandom();
 
-  /// Random number generator.
-  static std::mt19937 _gen;
+  /// Random number generator, one per thread.
+  static thread_local std::mt19937 _gen;
 
  private:
   /**
@@ -217,6 +368,59 @@ class Maze {
    */
   static bool EmptyPoint(const Cell &point);
 
+  /**
+   * @brief Fill the BFS predecessor of every cell reachable from root.
+   * @param root Root of the tree.
+   * @param prev Receives rows * cols predecessors, row-major; {-1, -1} for
+   * unreachable cells.
+   */
+  void BuildPathTree(Cell root, std::vector<Cell> &prev) const;
+
+  /**
+   * @brief Bidirectional search behind SearchMode::kBidirectional.
+   *
+   * Expands one whole level of the smaller frontier at a time; the first
+   * edge found between the two sides closes a shortest path.
+   * @param end End cell.
+   * @param start Start cell.
+   * @param pass Replaced with the path from end to start.
+   * @param workspace Scratch state holding both sides.
+   * @return true if a path was found.
+   */
+  bool SolveBidirectional(Cell end, Cell start, std::vector<Cell> &pass,
+                          SolverWorkspace &workspace) const;
+
+  /**
+   * @brief A* over the maze walls behind SearchMode::kAStar.
+   * @param end End cell.
+   * @param start Start cell.
+   * @param pass Replaced with the path from end to start.
+   * @return true if a path was found.
+   */
+  bool SolveAStar(Cell end, Cell start, std::vector<Cell> &pass) const;
+
+  /**
+   * @brief Walk from a cave cell in one direction to the next jump point.
+   *
+   * Vertical walks stop where a side cell opens up next to a solid one
+   * behind it; horizontal walks stop where a vertical walk would succeed.
+   * @param from Cell to walk from, not itself tested.
+   * @param direction Step index: up, down, right, left.
+   * @param end Goal, always a jump point.
+   * @param out Receives the jump point.
+   * @return false if the walk hits a solid cell or the border first.
+   */
+  bool Jump(Cell from, int direction, Cell end, Cell &out) const;
+
+  /**
+   * @brief Check if a cave cell is inside and dead.
+   * @param cell Cell to check.
+   * @return true if the cell can be walked through.
+   */
+  bool OpenCell(const Cell &cell) const {
+    return ValidPoint(cell) && !GetBit(_verticals[cell.r], cell.c);
+  }
+
   /**
    * @brief Update the cell state for a dead cell in cave evolution.
    * @param i Row index.
@@ -245,11 +449,17 @@ class Maze {
   /// Horizontal wall matrix.
   std::array<uint64_t, kMaxSize> _horizontals;
 
+  /// Cached cave labels, shared by copies; checked against the cells on use.
+  mutable std::shared_ptr<const CaveRegions> _regions;
+
+  /// Guards _regions so that concurrent Regions() calls are safe.
+  mutable std::mutex _regions_mutex;
+
   /// Distribution for random bits.
-  static std::uniform_int_distribution<> _dist_bit;
+  static thread_local std::uniform_int_distribution<> _dist_bit;
 
   /// Distribution for random real numbers.
-  static std::uniform_real_distribution<> _dist_real;
+  static thread_local std::uniform_real_distribution<> _dist_real;
 
   /**
    * @brief Generate a random bit (0 or 1).
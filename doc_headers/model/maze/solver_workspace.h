@@ -0,0 +1,113 @@
+/**
+ * @file solver_workspace.h
+ * @brief Reusable scratch state for breadth-first maze searches.
+ */
+
+#ifndef SOLVER_WORKSPACE_H_
+#define SOLVER_WORKSPACE_H_
+
+#include <array>
+#include <cstdint>
+
+#include "maze.h"
+
+/**
+ * @class SolverWorkspace
+ * @brief Fixed-size BFS state that is reused across searches without
+ * clearing.
+ *
+ * Cells are indexed r * kMaxSize + c. Visited marks are generation stamps,
+ * so Reset() only bumps a counter; the stamps are cleared when it wraps.
+ * Each cell keeps the direction it was entered from in 2 bits, which is
+ * enough to walk the path back to the start.
+ *
+ * A bidirectional search grows two sides with separate queues. A cell
+ * visited from side s is stamped generation + s, so the stamp also tells
+ * which side reached it.
+ */
+class SolverWorkspace {
+ public:
+  /// Number of cells addressable by the workspace.
+  static constexpr int kCells = kMaxSize * kMaxSize;
+
+  /// Zero-initializes the stamps, directions and queues.
+  SolverWorkspace() : m_stamps_(), m_directions_(), m_queues_() {}
+
+  /// Starts a new search: empties the queues and forgets all visited cells.
+  void Reset() {
+    m_heads_ = m_tails_ = {0, 0};
+    m_generation_ += 2;
+    if (m_generation_ == 0) {
+      m_stamps_.fill(0);
+      m_generation_ = 2;
+    }
+  }
+
+  /// Whether a cell was visited in the current search.
+  /// @param index Cell index.
+  /// @return true if Visit was called for it since the last Reset.
+  bool Visited(int index) const { return m_stamps_[index] >= m_generation_; }
+
+  /// Side that reached a visited cell.
+  /// @param index Cell index.
+  /// @return 0 or 1.
+  int Side(int index) const { return m_stamps_[index] - m_generation_; }
+
+  /// Marks a cell visited and records how it was entered.
+  /// @param index Cell index.
+  /// @param direction Index into the solver's step table, 0 to 3.
+  /// @param side Search side, 0 for one-sided searches.
+  void Visit(int index, int direction, int side = 0) {
+    m_stamps_[index] = m_generation_ + side;
+    uint8_t& byte = m_directions_[index >> 2];
+    int shift = (index & 3) << 1;
+    byte = (byte & ~(3u << shift)) | (direction << shift);
+  }
+
+  /// Direction a visited cell was entered from.
+  /// @param index Cell index.
+  /// @return Value passed to Visit.
+  int Direction(int index) const {
+    return (m_directions_[index >> 2] >> ((index & 3) << 1)) & 3;
+  }
+
+  /// Appends a cell to a side's queue. Each cell is pushed at most once per
+  /// search, so a ring never overwrites unread entries.
+  /// @param index Cell index.
+  /// @param side Search side.
+  void Push(int index, int side = 0) {
+    m_queues_[side][m_tails_[side]++ & kQueueMask] = index;
+  }
+
+  /// Removes the oldest queued cell of a side.
+  /// @param side Search side.
+  /// @return Cell index.
+  int Pop(int side = 0) {
+    return m_queues_[side][m_heads_[side]++ & kQueueMask];
+  }
+
+  /// Whether a side's queue is empty.
+  /// @param side Search side.
+  /// @return true if there is nothing left to pop.
+  bool Empty(int side = 0) const { return m_heads_[side] == m_tails_[side]; }
+
+  /// Number of queued cells of a side.
+  /// @param side Search side.
+  /// @return Queue length.
+  int Size(int side) const { return m_tails_[side] - m_heads_[side]; }
+
+ private:
+  /// Ring queue capacity minus one; a power of two of at least kCells.
+  static constexpr int kQueueMask = 4095;
+  static_assert(kQueueMask + 1 >= kCells);
+
+  std::array<uint32_t, kCells> m_stamps_;  ///< Generation of the last visit.
+  std::array<uint8_t, (kCells + 3) / 4> m_directions_;  ///< 2 bits per cell.
+  /// BFS ring queue per side.
+  std::array<std::array<uint16_t, kQueueMask + 1>, 2> m_queues_;
+  std::array<uint32_t, 2> m_heads_ = {0, 0};  ///< Next position to pop.
+  std::array<uint32_t, 2> m_tails_ = {0, 0};  ///< Next position to push.
+  uint32_t m_generation_ = 0;  ///< Even stamp of the current search.
+};
+
+#endif  // SOLVER_WORKSPACE_H_
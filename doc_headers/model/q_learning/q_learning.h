@@ -6,6 +6,7 @@
 #endif
 
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <ctime>
 #include <random>
@@ -84,6 +85,9 @@ class QLearning : public QObject {
 
   /**
    * @brief Starts the Q-learning training process.
+   *
+   * Seeds the calling thread's generator first, so training on a fresh
+   * thread does not explore from the default seed.
    */
   void Train();
 
@@ -114,7 +118,8 @@ class QLearning : public QObject {
 #endif
 
  private:
-  bool m_stop_requested_;  ///< Flag to indicate if stop was requested.
+  /// Set by StopLearning, possibly from another thread.
+  std::atomic<bool> m_stop_requested_;
   bool m_is_learning_;     ///< Flag to indicate if learning is in progress.
   Maze *m_pmaze_;          ///< Pointer to the maze.
   Cell m_goal_;            ///< Goal cell.
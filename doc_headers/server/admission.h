@@ -0,0 +1,82 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <QHash>
+#include <QHostAddress>
+
+/**
+ * @brief Admission control settings of TcpServer.
+ */
+struct ServerLimits {
+  /// Open connections above which new ones get 503.
+  int max_connections = 256;
+  /// Largest request line plus headers; larger requests get 431.
+  qsizetype max_header_bytes = 8 * 1024;
+  /// Largest Content-Length accepted; larger requests get 413.
+  qsizetype max_body_bytes = 1024 * 1024;
+  /// Token refill rate per client address, 0 disables rate limiting.
+  double requests_per_second = 20.0;
+  /// Bucket size, the number of requests a client may send at once.
+  double burst = 40.0;
+  /// Time allowed between reads before a request gets 408.
+  qint64 read_timeout_ms = 10 * 1000;
+  /// Time a response may make no progress before the connection is aborted.
+  qint64 write_timeout_ms = 30 * 1000;
+};
+
+/**
+ * @class RateLimiter
+ * @brief Token bucket per client address.
+ *
+ * Every connection takes one token; tokens refill at a fixed rate up to the
+ * burst size. Buckets that have refilled completely are removed by Prune.
+ */
+class RateLimiter {
+ public:
+  /**
+   * @brief Creates a limiter.
+   * @param rate Tokens added per second; 0 or less allows everything.
+   * @param burst Bucket capacity, at least 1.
+   */
+  RateLimiter(double rate, double burst);
+
+  /**
+   * @brief Takes a token for a connection.
+   * @param address Client address.
+   * @param now_ms Current time in milliseconds.
+   * @return false if the bucket is empty.
+   */
+  bool Allow(const QHostAddress& address, qint64 now_ms);
+
+  /**
+   * @brief Suggests a Retry-After value after Allow returned false.
+   * @param address Client address.
+   * @return Seconds until a token is available.
+   */
+  int RetryAfter(const QHostAddress& address) const;
+
+  /**
+   * @brief Removes buckets that are full again.
+   * @param now_ms Current time in milliseconds.
+   */
+  void Prune(qint64 now_ms);
+
+  /// @return Number of tracked addresses.
+  int Size() const;
+
+ private:
+  /// State of one address.
+  struct Bucket {
+    double tokens;      ///< Tokens left at updated_ms.
+    qint64 updated_ms;  ///< Time of the last update.
+  };
+
+  /// Tokens of a bucket at the given time.
+  double Refilled(const Bucket& bucket, qint64 now_ms) const;
+
+  double m_rate_;                          ///< Tokens per second.
+  double m_burst_;                         ///< Bucket capacity.
+  QHash<QHostAddress, Bucket> m_buckets_;  ///< Buckets by address.
+};
+
+#endif  // ADMISSION_H
@@ -0,0 +1,80 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief A static file held in memory.
+ */
+struct Asset {
+  QByteArray content;        ///< Raw file content.
+  QByteArray gzip;           ///< gzip variant, empty if not smaller.
+  QByteArray brotli;         ///< Brotli variant, empty if unavailable.
+  QByteArray content_type;   ///< MIME type derived from the suffix.
+  QByteArray etag;           ///< Quoted strong validator.
+  QByteArray last_modified;  ///< File time as an HTTP date.
+  QByteArray cache_control;  ///< Cache-Control value.
+};
+
+/**
+ * @class AssetCache
+ * @brief Static files of the web UI held in memory.
+ *
+ * Files are read once at startup together with precompressed variants, so
+ * GET requests never touch the disk.
+ */
+class AssetCache {
+ public:
+  /**
+   * @brief Loads every file below a directory.
+   * @param root Directory with the web UI.
+   * @param watch Reload files when they change on disk (inotify on Linux).
+   */
+  explicit AssetCache(const QString& root, bool watch = false);
+
+  /// Destructor.
+  ~AssetCache();
+
+  /**
+   * @brief Looks up a file by request path.
+   * @param path Request path, "/" maps to "/index.html".
+   * @return The cached file or nullptr.
+   */
+  const Asset* Find(const QString& path) const;
+
+  /// Number of cached files.
+  int Size() const;
+
+  /// Drops the cache and loads every file again.
+  void Reload();
+
+ private:
+  /// Loads or refreshes one file; removes it if it cannot be read.
+  void LoadFile(const QString& file_path);
+
+  /// Request path of a file below the root.
+  QString Key(const QString& file_path) const;
+
+  /// gzip-compresses data.
+  static QByteArray Gzip(const QByteArray& data);
+
+  /// Brotli-compresses data; empty when built without brotli.
+  static QByteArray Brotli(const QByteArray& data);
+
+  /// MIME type derived from the file suffix.
+  static QByteArray ContentType(const QString& file_path);
+
+  QString m_root_;                   ///< Absolute path of the root.
+  QHash<QString, Asset> m_assets_;   ///< Files keyed by request path.
+  QFileSystemWatcher* m_pwatcher_;   ///< Watcher, nullptr when disabled.
+};
+
+#endif  // ASSET_CACHE_H
@@ -0,0 +1,102 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <QByteArray>
+#include <QtEndian>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "../model/maze/maze.h"
+
+/**
+ * @class BinaryProtocol
+ * @brief Little-endian wire format for /generate and /pass.
+ *
+ * Used instead of JSON when the client sends or accepts
+ * application/octet-stream. Layouts:
+ * - /generate request: u16 rows, u16 cols
+ * - /generate response: u16 rows, u16 cols, u64 verticals[rows],
+ *   u64 horizontals[rows], u64 id
+ * - /pass request: u16 rows, u16 cols, u16 start_r, u16 start_c, u16 end_r,
+ *   u16 end_c, u64 verticals[rows], u64 horizontals[rows]
+ * - /pass response: u32 count, {u16 r, u16 c}[count]
+ * - /pass/batch request: u16 rows, u16 cols, u32 count, u64 verticals[rows],
+ *   u64 horizontals[rows], {u16 start_r, u16 start_c, u16 end_r,
+ *   u16 end_c}[count]
+ * - /pass/batch response: u32 count, then a /pass response per query
+ */
+class BinaryProtocol {
+ public:
+  /// MIME type selecting this format.
+  static constexpr const char* kContentType = "application/octet-stream";
+
+  /**
+   * @brief Reads a /generate request.
+   * @param data Request body.
+   * @param rows Receives the number of rows.
+   * @param cols Receives the number of columns.
+   * @return false if the body has the wrong size.
+   */
+  static bool ReadSize(const QByteArray& data, int& rows, int& cols);
+
+  /**
+   * @brief Reads a /pass request.
+   * @return false if the body is truncated or rows is out of range.
+   */
+  static bool ReadPathRequest(const QByteArray& data, int& rows, int& cols,
+                              Cell& start, Cell& end,
+                              std::array<uint64_t, kMaxSize>& verticals,
+                              std::array<uint64_t, kMaxSize>& horizontals);
+
+  /**
+   * @brief Reads a /pass/batch request.
+   * @param queries Receives (start, end) pairs, the order /pass passes to
+   * Maze::SolveMaze.
+   * @return false if the body is truncated or rows is out of range.
+   */
+  static bool ReadBatchRequest(const QByteArray& data, int& rows, int& cols,
+                               std::array<uint64_t, kMaxSize>& verticals,
+                               std::array<uint64_t, kMaxSize>& horizontals,
+                               std::vector<std::pair<Cell, Cell>>& queries);
+
+  /**
+   * @brief Encodes a maze as a /generate response.
+   * @param maze The maze to encode.
+   * @param id Session id of the maze.
+   * @return Encoded body.
+   */
+  static QByteArray WriteMaze(const Maze& maze, quint64 id);
+
+  /**
+   * @brief Encodes a path as a /pass response.
+   * @param pass The path to encode.
+   * @return Encoded body.
+   */
+  static QByteArray WritePath(const std::vector<Cell>& pass);
+
+  /**
+   * @brief Appends a path in the /pass response layout.
+   * @param out Output buffer.
+   * @param pass The path to encode.
+   */
+  static void AppendPath(QByteArray& out, const std::vector<Cell>& pass);
+
+  /**
+   * @brief Appends a u32 count.
+   * @param out Output buffer.
+   * @param count The count.
+   */
+  static void AppendCount(QByteArray& out, quint32 count);
+
+ private:
+  /// Appends a value in little-endian byte order.
+  template <typename T>
+  static void Append(QByteArray& out, T value);
+
+  /// Reads a little-endian value at the given offset.
+  template <typename T>
+  static T Read(const QByteArray& data, qsizetype offset);
+};
+
+#endif  // BINARY_PROTOCOL_H
@@ -0,0 +1,136 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Request class used as the route label.
+ */
+enum class Route {
+  kGenerate,  ///< POST /generate.
+  kPass,      ///< POST /pass.
+  kBatch,     ///< POST /pass/batch.
+  kTrain,     ///< POST /train, timed up to the stream header.
+  kCave,      ///< POST /cave/generate and /cave/step.
+  kStatic,    ///< GET of a web UI file.
+  kOptions,   ///< CORS preflight.
+  kMetrics,   ///< GET /metrics.
+  kOther      ///< Unknown path or method.
+};
+
+/**
+ * @brief Part of the request handling that is timed.
+ */
+enum class Phase {
+  kParse,    ///< Reading headers and decoding the body.
+  kCompute,  ///< Maze generation, solving or cave evolution.
+  kWrite,    ///< Queuing the response on the socket.
+  kTotal     ///< The whole request.
+};
+
+/// Number of Route values.
+constexpr int kRoutes = 9;
+/// Number of Phase values.
+constexpr int kPhases = 4;
+/// Status codes counted by ServerMetrics::CountRejected.
+constexpr std::array<int, 7> kRejectCodes = {400, 408, 411, 413,
+                                              429, 431, 503};
+
+/**
+ * @class LatencyHistogram
+ * @brief Lock-free log-bucketed latency histogram.
+ *
+ * Bucket i counts samples up to 2^i microseconds, the last bucket everything
+ * slower (about 8 s and up).
+ */
+class LatencyHistogram {
+ public:
+  /// Number of bounded buckets.
+  static constexpr int kBuckets = 24;
+
+  /**
+   * @brief Adds a sample to the first bucket whose bound is not below it.
+   * Nanoseconds are rounded up to whole microseconds first.
+   * @param ns Duration in nanoseconds.
+   */
+  void Record(int64_t ns);
+
+  /**
+   * @brief Appends the histogram as Prometheus _bucket, _sum and _count lines.
+   * @param out Output buffer.
+   * @param name Metric name.
+   * @param labels Label pairs without braces.
+   */
+  void Render(QByteArray& out, const QByteArray& name,
+              const QByteArray& labels) const;
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets + 1> m_buckets_{};  ///< Counts.
+  std::atomic<uint64_t> m_count_{0};   ///< Number of samples.
+  std::atomic<uint64_t> m_sum_ns_{0};  ///< Sum of samples in nanoseconds.
+};
+
+/**
+ * @class ServerMetrics
+ * @brief Lock-free server counters exposed on GET /metrics.
+ *
+ * Holds a latency histogram per route and phase, request counts, the
+ * connection gauge and byte counters. All updates are relaxed atomics.
+ */
+class ServerMetrics {
+ public:
+  /**
+   * @brief Records the duration of a phase.
+   * @param route The route of the request.
+   * @param phase The phase.
+   * @param ns Duration in nanoseconds.
+   */
+  void Record(Route route, Phase phase, int64_t ns);
+
+  /// Counts a received request.
+  void CountRequest(Route route);
+  /// Adds to the bytes read from clients.
+  void AddBytesIn(int64_t n);
+  /// Adds to the bytes written to clients.
+  void AddBytesOut(int64_t n);
+  /// Counts an accepted connection.
+  void ConnectionOpened();
+  /// Counts a closed connection.
+  void ConnectionClosed();
+  /// Counts a request refused with one of kRejectCodes.
+  void CountRejected(int status);
+
+  /**
+   * @brief Formats all metrics in the Prometheus text exposition format.
+   * @return The metrics text.
+   */
+  QByteArray Render() const;
+
+  /**
+   * @brief Monotonic clock used for the timings.
+   * @return Nanoseconds since an unspecified epoch.
+   */
+  static int64_t Now();
+
+ private:
+  /// Label value of a route.
+  static const char* RouteName(int route);
+  /// Label value of a phase.
+  static const char* PhaseName(int phase);
+
+  /// Latencies per route and phase.
+  std::array<std::array<LatencyHistogram, kPhases>, kRoutes> m_latency_;
+  std::array<std::atomic<uint64_t>, kRoutes> m_requests_{};  ///< Per route.
+  std::atomic<uint64_t> m_bytes_in_{0};           ///< Bytes received.
+  std::atomic<uint64_t> m_bytes_out_{0};          ///< Bytes sent.
+  std::atomic<int64_t> m_connections_{0};         ///< Open connections.
+  std::atomic<uint64_t> m_connections_total_{0};  ///< Accepted connections.
+  /// Refused requests per kRejectCodes entry.
+  std::array<std::atomic<uint64_t>, kRejectCodes.size()> m_rejected_{};
+};
+
+#endif  // METRICS_H
@@ -0,0 +1,85 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QtEndian>
+#include <array>
+#include <list>
+
+#include "../model/maze/maze.h"
+
+/**
+ * @class ResponseCache
+ * @brief Serialized /pass responses addressed by request content.
+ *
+ * The key packs dimensions, wall words, endpoints and response encoding, so
+ * identical mazes sent by different clients share one entry. Least recently
+ * used entries are evicted once the memory budget is exceeded.
+ */
+class ResponseCache {
+ public:
+  /**
+   * @brief Constructs an empty cache.
+   * @param budget_bytes Memory budget for keys, bodies and bookkeeping.
+   */
+  explicit ResponseCache(qsizetype budget_bytes = 16 * 1024 * 1024);
+
+  /**
+   * @brief Builds the content key of a /pass request.
+   * @param format Tag of the response encoding.
+   * @return Packed key bytes.
+   */
+  static QByteArray Key(int rows, int cols,
+                        const std::array<uint64_t, kMaxSize>& verticals,
+                        const std::array<uint64_t, kMaxSize>& horizontals,
+                        const Cell& start, const Cell& end, char format);
+
+  /**
+   * @brief Looks up a response and counts a hit or a miss.
+   * @param key Content key.
+   * @return Cached body or nullptr.
+   */
+  const QByteArray* Find(const QByteArray& key);
+
+  /**
+   * @brief Stores a response body, evicting old entries to fit the budget.
+   * @param key Content key.
+   * @param body Serialized response.
+   */
+  void Insert(const QByteArray& key, const QByteArray& body);
+
+  /// Number of lookups answered from the cache.
+  quint64 Hits() const;
+
+  /// Number of lookups not found in the cache.
+  quint64 Misses() const;
+
+  /// Accounted memory in bytes.
+  qsizetype Bytes() const;
+
+  /// Number of cached responses.
+  qsizetype Size() const;
+
+ private:
+  /// Cached body with its position in the LRU list.
+  struct Entry {
+    QByteArray body;
+    std::list<QByteArray>::iterator lru;
+  };
+
+  /// Accounted size of an entry.
+  static qsizetype Cost(const QByteArray& key, const QByteArray& body);
+
+  /// Drops the least recently used entry.
+  void EvictOldest();
+
+  qsizetype m_budget_;                  ///< Memory budget.
+  qsizetype m_bytes_;                   ///< Accounted memory.
+  quint64 m_hits_;                      ///< Hit counter.
+  quint64 m_misses_;                    ///< Miss counter.
+  QHash<QByteArray, Entry> m_entries_;  ///< Entries by key.
+  std::list<QByteArray> m_lru_;         ///< Keys, most recently used first.
+};
+
+#endif  // RESPONSE_CACHE_H
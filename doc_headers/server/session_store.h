@@ -0,0 +1,122 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRandomGenerator>
+#include <deque>
+#include <list>
+#include <vector>
+
+#include "../model/maze/maze.h"
+
+/**
+ * @brief A maze kept on the server between requests.
+ */
+struct MazeSession {
+  Maze maze;                                ///< The generated maze.
+  QHash<quint32, std::vector<Cell>> paths;  ///< Solved paths by endpoints.
+  std::deque<quint32> path_order;           ///< Path keys, oldest first.
+  qsizetype path_bytes = 0;                 ///< Charged for cached paths.
+  qint64 last_access = 0;                   ///< Time of last use, ms.
+};
+
+/**
+ * @class SessionStore
+ * @brief Mazes handed out by /generate.
+ *
+ * Lets /pass refer to a maze by id instead of resending the walls. Bounded
+ * by count (least recently used is evicted first) and by idle time. Cached
+ * paths share one byte budget; when it runs out, the oldest paths of the
+ * least recently used sessions are dropped first.
+ */
+class SessionStore {
+ public:
+  /**
+   * @brief Constructs an empty store.
+   * @param max_sessions Maximum number of stored mazes.
+   * @param ttl_ms Idle time after which a maze is dropped.
+   * @param max_paths Maximum number of cached paths per maze.
+   * @param max_path_bytes Memory budget for cached paths of all mazes.
+   */
+  explicit SessionStore(int max_sessions = 4096,
+                        qint64 ttl_ms = 30 * 60 * 1000, int max_paths = 256,
+                        qsizetype max_path_bytes = 32 * 1024 * 1024);
+
+  /**
+   * @brief Stores a maze, evicting the least recently used one if full.
+   * @param maze The maze to store.
+   * @return Random non-zero id of the maze.
+   */
+  quint64 Insert(const Maze& maze);
+
+  /**
+   * @brief Looks up a maze and marks it as recently used.
+   * @param id The maze id.
+   * @return The session or nullptr if unknown or expired.
+   */
+  MazeSession* Find(quint64 id);
+
+  /// Number of stored mazes.
+  int Size() const;
+
+  /// Bytes charged for cached paths across all mazes.
+  qsizetype PathBytes() const;
+
+  /**
+   * @brief Packs path endpoints into a cache key.
+   * @param start Start cell.
+   * @param end End cell.
+   * @return Key unique for cells inside kMaxSize.
+   */
+  static quint32 PathKey(const Cell& start, const Cell& end);
+
+  /**
+   * @brief Looks up a solved path.
+   * @return The path or nullptr.
+   */
+  const std::vector<Cell>* FindPath(MazeSession& session, quint32 key) const;
+
+  /**
+   * @brief Caches a solved path.
+   *
+   * A full session drops its oldest path. If the byte budget is exceeded,
+   * the oldest paths of the least recently used sessions are dropped until
+   * the new one fits. Paths larger than the whole budget are not cached.
+   * @param session Session the path belongs to.
+   * @param key Endpoints from PathKey.
+   * @param pass The solved path.
+   */
+  void StorePath(MazeSession& session, quint32 key,
+                 const std::vector<Cell>& pass);
+
+ private:
+  /// Stored session with its position in the LRU list.
+  struct Entry {
+    MazeSession session;
+    std::list<quint64>::iterator lru;
+  };
+
+  /// Removes sessions idle for longer than the TTL.
+  void DropExpired();
+
+  /// Removes one session.
+  void Remove(quint64 id);
+
+  /// Drops the oldest cached path of a session, if any.
+  void DropOldestPath(MazeSession& session);
+
+  /// Bytes charged for a cached path, cells plus bookkeeping.
+  static qsizetype PathCost(const std::vector<Cell>& pass);
+
+  int m_max_sessions_;                ///< Session limit.
+  qint64 m_ttl_ms_;                   ///< Idle timeout.
+  int m_max_paths_;                   ///< Per-session path cache limit.
+  qsizetype m_max_path_bytes_;        ///< Path cache budget.
+  qsizetype m_path_bytes_;            ///< Path bytes currently charged.
+  QElapsedTimer m_clock_;             ///< Monotonic clock.
+  QHash<quint64, Entry> m_sessions_;  ///< Sessions by id.
+  std::list<quint64> m_lru_;          ///< Ids, most recently used first.
+};
+
+#endif  // SESSION_STORE_H
@@ -4,6 +4,8 @@
 #include <QByteArray>
 #include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -11,10 +13,49 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QTextEdit>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <string_view>
 
 #include "../model/maze/maze.h"
+#include "admission.h"
+#include "asset_cache.h"
+#include "binary_protocol.h"
+#include "metrics.h"
+#include "response_cache.h"
+#include "session_store.h"
+#include "training_session.h"
+
+/**
+ * @brief Encoding of a request or response body.
+ */
+enum class WireFormat {
+  kJson,   ///< JSON, used by the web UI.
+  kBinary  ///< Little-endian application/octet-stream, see BinaryProtocol.
+};
+
+/**
+ * @brief A parsed HTTP request.
+ */
+struct HttpRequest {
+  QString method;                   ///< Request method (GET, POST, ...).
+  QString path;                     ///< Request target.
+  QHash<QString, QString> headers;  ///< Headers keyed by lower-case name.
+  QByteArray body;                  ///< Raw request body.
+};
+
+/**
+ * @brief Read progress of a client connection.
+ */
+struct ClientState {
+  QByteArray buffer;             ///< Bytes received so far.
+  HttpRequest request;           ///< Request line and headers once parsed.
+  qsizetype header_end = -1;     ///< Offset of the blank line, -1 if unseen.
+  qsizetype content_length = 0;  ///< Declared body size.
+  qint64 last_activity = 0;      ///< Last read or write, server clock ms.
+  bool responded = false;        ///< A response has been started.
+};
 
 /**
  * @brief The TcpServer class provides a TCP server implementation with
@@ -32,8 +73,12 @@ class TcpServer : public QWidget {
    * @brief Constructs a TCP server listening on the specified port.
    * @param port The port number to listen on.
    * @param parent The parent QWidget (optional).
+   * @param watch_assets Reload static files when they change on disk.
+   * @param limits Admission control settings.
    */
-  explicit TcpServer(quint16 port, QWidget* parent = nullptr);
+  explicit TcpServer(quint16 port, QWidget* parent = nullptr,
+                     bool watch_assets = false,
+                     const ServerLimits& limits = ServerLimits());
 
   /**
    * @brief Destructor that cleans up all client connections and server
@@ -49,6 +94,9 @@ class TcpServer : public QWidget {
 
   /**
    * @brief Processes data received from a client.
+   *
+   * Buffers the data until the headers and Content-Length bytes of body have
+   * arrived, then dispatches the request. Later data is ignored.
    * @param client The socket representing the client connection.
    */
   void OnReadyRead(QTcpSocket* client);
@@ -59,7 +107,49 @@ class TcpServer : public QWidget {
    */
   void OnClientDisconnected(QTcpSocket* client_socket);
 
+  /**
+   * @brief Closes connections that exceed the read or write timeout and
+   * prunes idle rate limiter buckets. Runs every second.
+   */
+  void OnSweep();
+
  private:
+  /**
+   * @brief Applies the connection cap and the per-address rate limit.
+   * @param client The new connection.
+   * @return false if the connection was refused with 503 or 429.
+   */
+  bool AdmitConnection(QTcpSocket* client);
+
+  /**
+   * @brief Parses the request line and headers once they are complete.
+   *
+   * Rejects oversized headers with 431, POST and PUT requests without
+   * Content-Length with 411 and bodies over the limit with 413.
+   * @param client The client socket.
+   * @param state Read progress of the client.
+   * @return false while more data is needed or after a rejection.
+   */
+  bool ReadHead(QTcpSocket* client, ClientState& state);
+
+  /**
+   * @brief Routes a complete request by method.
+   * @param client The client socket.
+   * @param request The request with its body.
+   */
+  void DispatchRequest(QTcpSocket* client, const HttpRequest& request);
+
+  /**
+   * @brief Refuses a request and counts it in the metrics.
+   * @param client The client socket.
+   * @param statusCode One of kRejectCodes.
+   * @param statusText Reason phrase, also sent as the body.
+   * @param extraHeaders Additional header lines such as Retry-After.
+   */
+  void Reject(QTcpSocket* client, int statusCode,
+              std::string_view statusText,
+              const QByteArray& extraHeaders = QByteArray());
+
   /**
    * @brief Validates JSON request structure for pathfinding requests.
    * @param client The client socket for sending error responses.
@@ -89,24 +179,54 @@ class TcpServer : public QWidget {
    * @brief Sends pathfinding solution to client.
    * @param client The client socket to send response to.
    * @param pass The solution path as vector of cells.
+   * @param format Encoding negotiated from the Accept header.
+   */
+  void SendPassResponce(QTcpSocket* client, const std::vector<Cell>& pass,
+                        WireFormat format);
+
+  /**
+   * @brief Serializes a path as a /pass response body.
+   * @param pass The solution path.
+   * @param format Response encoding.
+   * @return Encoded body.
+   */
+  static QByteArray EncodePass(const std::vector<Cell>& pass,
+                               WireFormat format);
+
+  /**
+   * @brief MIME type of a response encoding.
+   * @param format Response encoding.
+   * @return Content-Type value.
    */
-  void SendPassResponce(QTcpSocket* client, const std::vector<Cell>& pass);
+  static std::string_view ContentType(WireFormat format);
 
   /**
-   * @brief Determines content type based on file extension.
-   * @param filePath The path to the file.
-   * @return The MIME content type as string.
+   * @brief Parses header lines into a map keyed by lower-case name.
+   * @param lines Request head split into lines, request line first.
+   * @return Header values.
    */
-  QString GetContentType(const QString& filePath);
+  static QHash<QString, QString> ParseHeaders(const QStringList& lines);
+
+  /**
+   * @brief Detects the request body encoding from Content-Type.
+   * @param request The parsed request.
+   * @return kBinary for application/octet-stream, kJson otherwise.
+   */
+  static WireFormat RequestFormat(const HttpRequest& request);
+
+  /**
+   * @brief Detects the preferred response encoding from Accept.
+   * @param request The parsed request.
+   * @return kBinary if application/octet-stream is accepted, kJson otherwise.
+   */
+  static WireFormat ResponseFormat(const HttpRequest& request);
 
   /**
    * @brief Processes POST requests.
    * @param client The client socket.
-   * @param path The request path.
-   * @param body The request body.
+   * @param request The parsed request.
    */
-  void ProceedPostRequest(QTcpSocket* client, const QString& path,
-                          const QByteArray& body);
+  void ProceedPostRequest(QTcpSocket* client, const HttpRequest& request);
 
   /**
    * @brief Processes OPTIONS requests (for CORS).
@@ -115,33 +235,196 @@ class TcpServer : public QWidget {
   void ProceedOptionRequest(QTcpSocket* client);
 
   /**
-   * @brief Processes GET requests (serves static files).
+   * @brief Processes GET requests (serves static files from the cache).
+   *
+   * Answers 304 when If-None-Match or If-Modified-Since match the cached
+   * file and picks a precompressed variant according to Accept-Encoding.
    * @param client The client socket.
-   * @param path The request path.
+   * @param request The parsed request.
    */
-  void ProceedGetRequest(QTcpSocket* client, const QString& path);
+  void ProceedGetRequest(QTcpSocket* client, const HttpRequest& request);
+
+  /**
+   * @brief Sends the server metrics in the Prometheus text format.
+   * @param client The client socket.
+   */
+  void ProceedMetrics(QTcpSocket* client);
+
+  /**
+   * @brief Classifies a request for the metrics labels.
+   * @param request The parsed request.
+   * @return The route the request is counted under.
+   */
+  static Route RouteOf(const HttpRequest& request);
+
+  /**
+   * @brief Records the parse phase of the current request once.
+   *
+   * Called when compute or write starts, whichever comes first.
+   */
+  void EndParse();
+
+  /**
+   * @brief Records a phase of the current request.
+   * @param phase The phase.
+   * @param since Start of the phase from ServerMetrics::Now().
+   */
+  void RecordPhase(Phase phase, int64_t since);
+
+  /**
+   * @brief Checks whether an Accept-Encoding header allows a coding.
+   * @param header The Accept-Encoding value.
+   * @param coding The content coding, e.g. "gzip".
+   * @return true if the coding is listed with a non-zero q-value.
+   */
+  static bool AcceptsEncoding(const QString& header, const QString& coding);
+
+  /**
+   * @brief Sends a 304 Not Modified response for a cached file.
+   * @param client The client socket.
+   * @param asset The cached file.
+   */
+  void SendNotModified(QTcpSocket* client, const Asset& asset);
 
   /**
    * @brief Generates and sends a new maze to client.
    * @param client The client socket.
    * @param rows Number of rows in the maze.
    * @param cols Number of columns in the maze.
+   * @param format Response encoding.
    */
-  void SendGeneratedMaze(QTcpSocket* client, int rows, int cols);
+  void SendGeneratedMaze(QTcpSocket* client, int rows, int cols,
+                         WireFormat format);
 
   /**
    * @brief Processes maze generation requests.
    * @param client The client socket.
-   * @param body The request body containing generation parameters.
+   * @param request The request containing generation parameters.
    */
-  void ProceedGenerate(QTcpSocket* client, const QByteArray& body);
+  void ProceedGenerate(QTcpSocket* client, const HttpRequest& request);
 
   /**
    * @brief Processes pathfinding requests.
    * @param client The client socket.
-   * @param body The request body containing maze and path parameters.
+   * @param request The request containing maze and path parameters.
    */
-  void ProceedPath(QTcpSocket* client, const QByteArray& body);
+  void ProceedPath(QTcpSocket* client, const HttpRequest& request);
+
+  /**
+   * @brief Solves a path in a maze stored by /generate.
+   *
+   * Paths already solved for the same endpoints are answered from the
+   * session without running BFS.
+   * @param client The client socket.
+   * @param obj Request object with id, start and end.
+   * @param format Response encoding.
+   */
+  void ProceedSessionPath(QTcpSocket* client, const QJsonObject& obj,
+                          WireFormat format);
+
+  /**
+   * @brief Extracts maze and path parameters from a JSON request object.
+   *
+   * Sends a 400 response to the client on failure.
+   * @return true if all parameters were parsed.
+   */
+  bool ParseJsonPath(QTcpSocket* client, const QJsonObject& obj, int& rows,
+                     int& cols, Cell& start, Cell& end,
+                     std::array<uint64_t, kMaxSize>& verticals,
+                     std::array<uint64_t, kMaxSize>& horizontals);
+
+  /**
+   * @brief Reads rows, cols and the wall arrays of a JSON request.
+   * @return false if an error response has been sent.
+   */
+  bool ParseJsonWalls(QTcpSocket* client, const QJsonObject& obj, int& rows,
+                      int& cols, std::array<uint64_t, kMaxSize>& verticals,
+                      std::array<uint64_t, kMaxSize>& horizontals);
+
+  /**
+   * @brief Handles POST /pass/batch.
+   *
+   * Takes one maze (walls or a session id) and a list of start/end pairs,
+   * solves them with Maze::SolveMazeBatch and streams the paths back in
+   * query order. An empty batch is rejected with 400. One thread is used
+   * per 256 queries, up to the hardware concurrency.
+   * @param client The client socket.
+   * @param request The parsed request.
+   */
+  void ProceedBatch(QTcpSocket* client, const HttpRequest& request);
+
+  /**
+   * @brief Reads the maze and the "pairs" array of a JSON batch request.
+   * A missing, non-array or empty "pairs" is rejected with 400.
+   * @param client The client socket.
+   * @param obj The request object.
+   * @param maze Receives the maze.
+   * @param queries Receives (start, end) pairs.
+   * @return false if an error response has been sent.
+   */
+  bool ParseJsonBatch(QTcpSocket* client, const QJsonObject& obj, Maze& maze,
+                      std::vector<std::pair<Cell, Cell>>& queries);
+
+  /**
+   * @brief Streams batch results with chunked transfer encoding.
+   * @param client The client socket.
+   * @param passes One path per query, empty if unreachable.
+   * @param format Response encoding.
+   */
+  void SendBatchResponse(QTcpSocket* client,
+                         const std::vector<std::vector<Cell>>& passes,
+                         WireFormat format);
+
+  /**
+   * @brief Writes data as one HTTP chunk and clears it.
+   * @param client The client socket.
+   * @param data Chunk payload; nothing is written if empty.
+   */
+  void WriteChunk(QTcpSocket* client, QByteArray& data);
+
+  /**
+   * @brief Handles POST /train.
+   *
+   * Takes a maze (walls or a session id) with start and end, replies with a
+   * text/event-stream header and hands the connection to a TrainingSession.
+   * At most two trainings run at once; further requests get 503.
+   * @param client The client socket.
+   * @param request The parsed request.
+   */
+  void ProceedTrain(QTcpSocket* client, const HttpRequest& request);
+
+  /**
+   * @brief Handles POST /cave/generate and POST /cave/step.
+   *
+   * /cave/generate fills a rows x cols cave with the given chance;
+   * /cave/step takes the packed rows in "cells". The cave is then evolved
+   * for "steps" generations in one request. With "until_stable" it runs
+   * until the cave is still or repeats a state (Maze::RunCaveToStable),
+   * at any radius. A "radius" of 2 or 3 counts neighbours in a larger square
+   * (Maze::SolveCaveRadius).
+   * With "min_region", regions smaller than that are filled and the rest
+   * are joined by tunnels (Maze::ConnectCave).
+   * @param client The client socket.
+   * @param request The parsed request.
+   */
+  void ProceedCave(QTcpSocket* client, const HttpRequest& request);
+
+  /**
+   * @brief Reads birth, death, the step count and the neighbourhood radius
+   * of a cave request. The radius defaults to 1, the Moore neighbourhood.
+   * @return false if an error response has been sent.
+   */
+  bool ParseCaveRules(QTcpSocket* client, const QJsonObject& obj, int& birth,
+                      int& death, int& steps, int& radius);
+
+  /**
+   * @brief Sends a cave as {"cells": [...], "steps": n, "stable": b,
+   * "period": p}.
+   * @param client The client socket.
+   * @param cave The evolved cave.
+   * @param run Steps performed and the period reached, 0 if none.
+   */
+  void SendCave(QTcpSocket* client, const Maze& cave, const CaveRun& run);
 
   /**
    * @brief Sends an HTTP response to the client.
@@ -150,14 +433,40 @@ class TcpServer : public QWidget {
    * @param statusText HTTP status text.
    * @param body Response body.
    * @param contentType Response content type.
+   * @param extraHeaders Additional header lines, each ending with CRLF.
    */
   void SendHttpResponse(QTcpSocket* client, int statusCode,
-                        const QString& statusText, const QByteArray& body,
-                        const QString& contentType);
+                        std::string_view statusText, const QByteArray& body,
+                        std::string_view contentType,
+                        const QByteArray& extraHeaders = QByteArray());
+
+  /**
+   * @brief Writes a response and closes the connection.
+   *
+   * Times the write phase and counts the bytes sent.
+   * @param client The client socket.
+   * @param header Status line and headers, including the blank line.
+   * @param body Response body, may be empty.
+   */
+  void WriteResponse(QTcpSocket* client, const QByteArray& header,
+                     const QByteArray& body = QByteArray());
 
   QTcpServer* m_ptcp_server_;     ///< The TCP server instance.
   QTextEdit* m_ptxt_;             ///< Text edit for logging server activity.
-  QList<QTcpSocket*> m_clients_;  ///< List of connected client sockets.
+  QHash<QTcpSocket*, ClientState> m_clients_;  ///< Connected clients.
+  ServerLimits m_limits_;                      ///< Admission control limits.
+  RateLimiter m_rate_limiter_;                 ///< Per-address token buckets.
+  QElapsedTimer m_clock_;                      ///< Clock for the timeouts.
+  QTimer* m_psweep_timer_;                     ///< Drives OnSweep.
+  AssetCache m_assets_;           ///< Static files of the web UI.
+  SessionStore m_sessions_;       ///< Mazes generated for clients.
+  ResponseCache m_responses_;     ///< /pass responses by request content.
+  ServerMetrics m_metrics_;       ///< Counters served on GET /metrics.
+  Route m_route_;                 ///< Route of the current request.
+  int64_t m_request_start_;       ///< When the current request was read.
+  bool m_parsing_;                ///< Parse phase not yet recorded.
+  int m_trainings_;               ///< Running TrainingSession objects.
+  std::vector<Cell> m_pass_;      ///< Path buffer reused by /pass solves.
 };
 
 #endif  // TCPSERVER_H
\ No newline at end of file
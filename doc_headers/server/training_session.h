@@ -0,0 +1,81 @@
+#ifndef TRAINING_SESSION_H
+#define TRAINING_SESSION_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QThread>
+
+#include "../model/maze/maze.h"
+#include "../model/q_learning/q_learning.h"
+
+/**
+ * @class TrainingSession
+ * @brief Runs one /train request and streams it as server-sent events.
+ *
+ * QLearning::Train runs on a worker thread while the agent object stays in
+ * the server thread. The client receives:
+ * - `event: progress` with `{"percent": p}` for each percent of training;
+ * - `event: path` with `{"pass": [[r, c], ...]}`, the greedy path from start
+ *   to the goal (empty if the agent did not reach it);
+ * - `event: done`, after which the connection is closed.
+ *
+ * A client disconnect calls QLearning::StopLearning. The session deletes
+ * itself once the worker thread has finished.
+ */
+class TrainingSession : public QObject {
+  Q_OBJECT
+
+ public:
+  /**
+   * @brief Prepares the agent; training begins with Start().
+   * @param maze The maze to learn, copied.
+   * @param start Cell the final path starts from.
+   * @param goal Goal cell of the agent.
+   * @param client Socket the events are written to.
+   * @param parent Parent object.
+   */
+  TrainingSession(const Maze& maze, Cell start, Cell goal, QTcpSocket* client,
+                  QObject* parent = nullptr);
+
+  /// Stops training and waits for the worker thread.
+  ~TrainingSession();
+
+  /// Starts the worker thread.
+  void Start();
+
+ signals:
+  /**
+   * @brief Emitted after writing to the client.
+   * @param bytes Number of bytes written.
+   */
+  void BytesSent(qint64 bytes);
+
+ private slots:
+  /// Sends a progress event.
+  void OnProgress(int percent);
+
+  /// Sends the path and closes the stream, then deletes the session.
+  void OnFinished();
+
+ private:
+  /**
+   * @brief Writes one server-sent event.
+   * @param event Event name.
+   * @param data Single-line event data.
+   */
+  void SendEvent(const char* event, const QByteArray& data);
+
+  /// @return true while the client socket is connected.
+  bool ClientConnected() const;
+
+  Maze m_maze_;                     ///< Maze the agent learns.
+  Cell m_start_;                    ///< Start of the reported path.
+  Cell m_goal_;                     ///< Goal of the agent.
+  QLearning m_agent_;               ///< The learning agent.
+  QThread* m_pthread_;              ///< Worker running Train.
+  QPointer<QTcpSocket> m_pclient_;  ///< Client, cleared when deleted.
+};
+
+#endif  // TRAINING_SESSION_H
@@ -1,9 +1,11 @@
 #ifndef DRAW_BONUS_H_
 #define DRAW_BONUS_H_
 
+#include <QImage>
 #include <QPainter>
 #include <QTimer>
 #include <QWidget>
+#include <array>
 
 #include "../model/maze/maze.h"
 
@@ -13,7 +15,8 @@
  *
  * This widget animates the progression through multiple solution paths in a
  * maze, showing each step with a color gradient from blue (start) to green to
- * red (end).
+ * red (end). Revealed levels accumulate in an image with one pixel per cell,
+ * so each animation tick only writes the cells of the new level.
  */
 class BonusDrawWidget : public QWidget {
   Q_OBJECT
@@ -25,19 +28,17 @@ class BonusDrawWidget : public QWidget {
   explicit BonusDrawWidget(QWidget* parent = nullptr);
 
   /**
-   * @brief Sets the solution paths to be visualized.
-   * @param solution Vector of solution paths where each path is a vector of
-   * Cells.
-   * @param rows Number of rows in the maze.
-   * @param cols Number of columns in the maze.
+   * @brief Sets the distances to be visualized and restarts the animation.
+   * @param solution Result of Maze::DistanceMatrix, moved into the widget.
    */
-  void SetSolution(const std::vector<std::vector<Cell>>& solution, int rows,
-                   int cols);
+  void SetSolution(DistanceMap&& solution);
 
  protected:
   /**
    * @brief Handles paint events for the widget.
    * @param event The paint event (unused).
+   *
+   * Scales the heat image to whole cells without smoothing.
    */
   void paintEvent(QPaintEvent*) override;
 
@@ -48,23 +49,25 @@ class BonusDrawWidget : public QWidget {
   void NextStep();
 
  private:
+  /// Number of entries in the heat palette.
+  static constexpr int kPaletteSize = 256;
+
+  /**
+   * @brief Heat colours from blue to red, half transparent and premultiplied.
+   * @return Palette built on first use.
+   */
+  static const std::array<QRgb, kPaletteSize>& Palette();
+
   /**
-   * @brief Draws a single point in the maze.
-   * @param painter The QPainter to use for drawing.
-   * @param point The cell coordinates to draw.
-   * @param cell_width Width of a single maze cell in pixels.
-   * @param cell_height Height of a single maze cell in pixels.
-   * @param size Size of the point to draw (unused in current implementation).
-   * @param color The color to use for drawing.
+   * @brief Writes the cells of one level into the heat image.
+   * @param level Index into the solution levels.
    */
-  void DrawPoint(QPainter& painter, const Cell& point, int cell_width,
-                 int cell_height, int size, const QColor& color);
+  void PaintLevel(int level);
 
-  int m_rows_;  ///< Number of rows in the maze.
-  int m_cols_;  ///< Number of columns in the maze.
-  std::vector<std::vector<Cell>>
-      m_solution_;      ///< Collection of solution paths to visualize.
+  DistanceMap m_solution_;  ///< Distances being visualized.
   int m_current_step_;  ///< Current animation step index.
+  QImage m_heat_;  ///< Revealed levels, one pixel per cell, transparent if
+                   ///< not yet reached.
 };
 
 #endif  // DRAW_BONUS_H_
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef DRAW_CAVE_H_
 #define DRAW_CAVE_H_
 
+#include <QImage>
 #include <QPainter>
 #include <QWidget>
 
@@ -10,8 +11,8 @@
  * @brief The CaveDrawWidget class provides visualization for a cave structure.
  *
  * This widget renders a cave represented by a Maze object, displaying live
- * cells as black rectangles and dead cells as white space. The visualization
- * automatically scales to fit the available widget space.
+ * cells as black and dead cells as white. The row words are copied into a
+ * one-bit image that is scaled to the widget with nearest-neighbour sampling.
  */
 class CaveDrawWidget : public QWidget {
   Q_OBJECT
@@ -27,20 +28,40 @@ class CaveDrawWidget : public QWidget {
    */
   explicit CaveDrawWidget(Maze* cave, QWidget* parent = nullptr);
 
+  /**
+   * @brief Schedules a repaint of the changed rows only.
+   * @param changed Row mask from Maze::SolveCave; each run of set bits
+   * becomes one update(QRect) band.
+   */
+  void UpdateRows(uint64_t changed);
+
  protected:
   /**
    * @brief Handles paint events for the widget.
-   * @param event The paint event (unused).
+   * @param event The paint event; only rows inside its rectangle are drawn.
    *
-   * Renders the cave by drawing each live cell (bit set to 1) as a black
-   * rectangle and dead cells (bit set to 0) as white space. The cells are
-   * scaled proportionally to fit the current widget dimensions.
+   * Refreshes the cave image and draws it scaled to whole cells, so each
+   * cell keeps the same size as in the rest of the views.
    */
-  void paintEvent(QPaintEvent*) override;
+  void paintEvent(QPaintEvent* event) override;
 
  private:
+  /**
+   * @brief Copies the row words into m_image_, reallocating it on resize.
+   * @param rows Number of rows.
+   * @param cols Number of columns.
+   */
+  void UpdateImage(int rows, int cols);
+
+  /**
+   * @brief Cell size in pixels for the current widget size.
+   * @return Cell width and height, at least 1.
+   */
+  QSize CellSize() const;
+
   Maze* m_pcave_;  ///< Pointer to the Maze object representing the cave to
                    ///< visualize.
+  QImage m_image_;  ///< Format_MonoLSB image, one bit per cell.
 };
 
 #endif  // DRAW_CAVE_H_
\ No newline at end of file
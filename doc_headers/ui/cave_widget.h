@@ -15,6 +15,7 @@
 
 #include "../model/maze/maze.h"
 #include "cave_draw.h"
+#include "gl_maze_view.h"
 #include "loader.h"
 #include "maze_style.h"
 
@@ -34,10 +35,11 @@ class CaveWidget : public QWidget {
   /**
    * @brief Constructs a CaveWidget with default parameters.
    * @param parent The parent widget (optional).
+   * @param use_gl Draw through GlMazeView instead of CaveDrawWidget.
    *
    * Initializes a cave with default size (kMaxSize/2) and random generation.
    */
-  explicit CaveWidget(QWidget* parent = nullptr);
+  explicit CaveWidget(QWidget* parent = nullptr, bool use_gl = false);
 
  signals:
   /**
@@ -68,7 +70,9 @@ class CaveWidget : public QWidget {
   double m_chance_;               ///< Initial cell spawn probability (0.0-1.0)
   QSpinBox* m_birth_;             ///< Control for birth limit parameter
   QSpinBox* m_death_;             ///< Control for death limit parameter
+  QSpinBox* m_radius_;            ///< Control for neighbourhood radius
   CaveDrawWidget* m_pcave_view_;  ///< Visualization widget for the cave
+  GlMazeView* m_pgl_view_;        ///< OpenGL view used instead, or null
 
   /**
    * @brief Creates the side control panel.
@@ -130,6 +134,17 @@ class CaveWidget : public QWidget {
    * @return Configured toolbox widget.
    */
   QWidget* CreatePageSwitcher(QWidget* parent);
+
+  /**
+   * @brief Redraws the whole cave after it was generated or loaded.
+   */
+  void RedrawCave();
+
+  /**
+   * @brief Redraws the cave after a step.
+   * @param changed Bit i set if row i changed.
+   */
+  void RedrawRows(uint64_t changed);
 };
 
 #endif
\ No newline at end of file
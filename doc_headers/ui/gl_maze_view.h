@@ -0,0 +1,119 @@
+#ifndef GL_MAZE_VIEW_H_
+#define GL_MAZE_VIEW_H_
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWidget>
+#include <QTimer>
+#include <array>
+#include <vector>
+
+#include "../model/maze/maze.h"
+
+/**
+ * @class GlMazeView
+ * @brief OpenGL view of a maze or cave with the path and heatmap overlays.
+ *
+ * The packed wall words and the per-cell overlay data are uploaded as integer
+ * textures when they change and the whole grid is drawn by one fragment shader
+ * on a full-screen triangle. Animating the path or the heatmap only changes a
+ * uniform, so a frame costs the same regardless of what is shown.
+ *
+ * MazeWidget and CaveWidget use it instead of the QPainter views when the
+ * application is started with --gl and Supported() holds.
+ */
+class GlMazeView : public QOpenGLWidget, protected QOpenGLFunctions {
+  Q_OBJECT
+ public:
+  /// What the wall words mean.
+  enum class Mode {
+    kMaze,  ///< Vertical and horizontal walls.
+    kCave   ///< Live cells in the vertical words.
+  };
+
+  /**
+   * @brief Constructs the view and requests an OpenGL 3.3 core context.
+   * @param mode Maze or cave rendering.
+   * @param parent Optional parent widget.
+   */
+  explicit GlMazeView(Mode mode, QWidget* parent = nullptr);
+
+  /// Releases the textures and the vertex array in the widget's context.
+  ~GlMazeView();
+
+  /**
+   * @brief Whether an OpenGL 3.3 core context can be created.
+   * @return false if the QPainter views have to be used instead.
+   */
+  static bool Supported();
+
+  /**
+   * @brief Copies the maze words and clears the overlay.
+   * @param maze Maze or cave to show.
+   */
+  void SetMaze(const Maze& maze);
+
+  /**
+   * @brief Shows a path, revealing one step every 50 ms.
+   * @param path Cells from the first to the last point.
+   */
+  void SetPath(std::vector<Cell> path);
+
+  /// Replaces the heatmap with the last path and reveals it again.
+  void ShowPath();
+
+  /**
+   * @brief Shows a distance heatmap, revealing one level every 30 ms.
+   * @param levels Distances from the chosen cell.
+   */
+  void SetHeat(const DistanceMap& levels);
+
+  /// Removes the path and the heatmap.
+  void ClearOverlay();
+
+ protected:
+  /// Compiles the shaders and creates the vertex array and the textures.
+  void initializeGL() override;
+
+  /// Uploads stale textures and draws the grid.
+  void paintGL() override;
+
+ private slots:
+  /// Reveals the next path step or heatmap level.
+  void NextStep();
+
+ private:
+  /**
+   * @brief Marks the overlay stale and restarts the reveal timer.
+   * @param steps Number of steps to reveal, 0 to stop.
+   * @param interval_ms Delay between steps.
+   */
+  void StartAnimation(int steps, int interval_ms);
+
+  /// Uploads m_words_ and m_cells_; needs the widget's context.
+  void UploadTextures();
+
+  Mode m_mode_;    ///< Maze or cave rendering.
+  int m_rows_;     ///< Number of rows.
+  int m_cols_;     ///< Number of columns.
+  /// Per row: vertical low/high and horizontal low/high 32-bit halves.
+  std::array<quint32, 4 * kMaxSize> m_words_;
+  /// Per cell: path index + 1 and heat level + 1, 0 when unset.
+  std::vector<quint16> m_cells_;
+  std::vector<Cell> m_path_;  ///< Last path, shown again after a heatmap.
+  int m_path_length_;  ///< Number of path cells.
+  int m_heat_levels_;  ///< Number of heatmap levels.
+  int m_visible_;      ///< Revealed steps or levels.
+  int m_steps_;        ///< Steps or levels to reveal.
+  bool m_dirty_;       ///< Textures need uploading.
+
+  QTimer* m_ptimer_;                ///< Reveal timer.
+  QOpenGLShaderProgram m_program_;  ///< Grid shader.
+  QOpenGLVertexArrayObject m_vao_;  ///< Empty VAO required by core profile.
+  GLuint m_words_texture_;          ///< RG32UI, 2 x rows.
+  GLuint m_cells_texture_;          ///< RG16UI, cols x rows.
+};
+
+#endif  // GL_MAZE_VIEW_H_
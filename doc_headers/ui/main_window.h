@@ -22,8 +22,9 @@ class MazeWindow : public QMainWindow {
   /**
    * @brief Constructs the MazeWindow.
    * @param parent Optional parent widget.
+   * @param use_gl Draw mazes and caves through GlMazeView.
    */
-  explicit MazeWindow(QWidget* parent = nullptr);
+  explicit MazeWindow(QWidget* parent = nullptr, bool use_gl = false);
 
  private:
   /**
@@ -42,6 +43,8 @@ class MazeWindow : public QMainWindow {
    * @param button Pointer to the QPushButton to adjust.
    */
   void AdjustButtonFonts(QPushButton* button);
+
+  bool m_use_gl_;  ///< Passed on to MazeWidget and CaveWidget.
 };
 
 #endif  // MAZE_WINDOW_H_
@@ -1,6 +1,9 @@
 #ifndef DRAW_MAZE_H_
 #define DRAW_MAZE_H_
 
+#include <QLine>
+#include <QPixmap>
+#include <QVector>
 #include <QWidget>
 
 #include "../model/maze/maze.h"
@@ -9,7 +12,9 @@
  * @class MazeDrawWidget
  * @brief Widget for visualizing a Maze object.
  *
- * Draws the maze grid with walls using Qt painting system.
+ * Draws the maze grid with walls using Qt painting system. The walls are
+ * rasterized once into a pixmap that paintEvent blits, so repaints caused by
+ * the path overlay do not redraw every wall.
  */
 class MazeDrawWidget : public QWidget {
   Q_OBJECT
@@ -24,6 +29,9 @@ class MazeDrawWidget : public QWidget {
 
   /**
    * @brief Sets the Maze object to visualize.
+   *
+   * Also call this after changing the maze in place, it invalidates the
+   * cached walls.
    * @param maze Pointer to the Maze.
    */
   void SetMaze(Maze* maze);
@@ -35,8 +43,38 @@ class MazeDrawWidget : public QWidget {
    */
   void paintEvent(QPaintEvent* event) override;
 
+  /**
+   * @brief Invalidates the cached walls.
+   * @param event Resize event pointer (unused).
+   */
+  void resizeEvent(QResizeEvent* event) override;
+
  private:
-  Maze* m_pmaze_;  ///< Pointer to the Maze to draw.
+  /// Draws the walls into m_walls_ at the current size with one drawLines.
+  void RenderWalls();
+
+  /**
+   * @brief Appends vertical walls, merging the same column across rows.
+   * @param rows Number of rows.
+   * @param cols Number of columns.
+   * @param cell_width Cell width in pixels.
+   * @param cell_height Cell height in pixels.
+   */
+  void AppendVerticalRuns(int rows, int cols, int cell_width, int cell_height);
+
+  /**
+   * @brief Appends horizontal walls, one segment per run of set bits.
+   * @param rows Number of rows.
+   * @param cols Number of columns.
+   * @param cell_width Cell width in pixels.
+   * @param cell_height Cell height in pixels.
+   */
+  void AppendHorizontalRuns(int rows, int cols, int cell_width,
+                            int cell_height);
+
+  Maze* m_pmaze_;           ///< Pointer to the Maze to draw.
+  QPixmap m_walls_;         ///< Rasterized walls, null when stale.
+  QVector<QLine> m_lines_;  ///< Merged wall segments, reused.
 };
 
 #endif  // DRAW_MAZE_H_
@@ -17,6 +17,7 @@
 #include "../model/maze/maze.h"
 #include "../model/q_learning/q_learning.h"
 #include "bonus_draw.h"
+#include "gl_maze_view.h"
 #include "loader.h"
 #include "maze_draw.h"
 #include "maze_style.h"
@@ -41,10 +42,11 @@ class MazeWidget : public QWidget {
   /**
    * @brief Constructs a MazeWidget with default parameters.
    * @param parent The parent widget (optional).
+   * @param use_gl Draw through GlMazeView instead of the QPainter views.
    *
    * Initializes a maze with default size (10x10) and random generation.
    */
-  explicit MazeWidget(QWidget* parent = nullptr);
+  explicit MazeWidget(QWidget* parent = nullptr, bool use_gl = false);
 
  signals:
   /**
@@ -83,7 +85,7 @@ class MazeWidget : public QWidget {
   MazeDrawWidget* m_pmaze_view_;    ///< Visualization widget for the maze
   PathDrawWidget* m_ppath_view_;    ///< Widget for displaying solution paths
   BonusDrawWidget* m_pbonus_view_;  ///< Widget for bonus visualization
-  std::vector<Cell> m_solution_;    ///< Current solution path
+  GlMazeView* m_pgl_view_;  ///< OpenGL view replacing the three above, or null
 
   /**
    * @brief Creates the side control panel.
@@ -107,9 +109,32 @@ class MazeWidget : public QWidget {
 
   /**
    * @brief Creates the main maze visualization area.
+   * @param use_gl Create a GlMazeView instead of the QPainter views.
    * @return Configured widget with maze visualization.
    */
-  QWidget* MazeDrawing();
+  QWidget* MazeDrawing(bool use_gl);
+
+  /**
+   * @brief Shows the current maze with an empty overlay.
+   */
+  void ShowMaze();
+
+  /**
+   * @brief Shows a path over the maze.
+   * @param path Cells from the first to the last point.
+   */
+  void ShowPath(std::vector<Cell>&& path);
+
+  /**
+   * @brief Shows a distance heatmap in place of the path.
+   * @param levels Distances from the chosen cell.
+   */
+  void ShowHeat(DistanceMap&& levels);
+
+  /**
+   * @brief Hides the heatmap and shows the path again.
+   */
+  void HideHeat();
 
   /**
    * @brief Updates solution visualization for single point.
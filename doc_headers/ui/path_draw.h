@@ -27,11 +27,11 @@ class PathDrawWidget : public QWidget {
 
   /**
    * @brief Sets the solution path to display and resets animation.
-   * @param solution Vector of cells representing the solution path.
+   * @param solution Cells of the solution path, moved into the widget.
    * @param rows Number of rows in the maze grid.
    * @param cols Number of columns in the maze grid.
    */
-  void SetSolution(const std::vector<Cell>& solution, int rows, int cols);
+  void SetSolution(std::vector<Cell>&& solution, int rows, int cols);
 
  protected:
   /**
@@ -1,5 +1,107 @@
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+#include "cave_regions.h"
 #include "maze.h"
 
+namespace {
+// Adds a plane of 0/1 neighbours to four bit-sliced counters: bit b of
+// every cell's count lives in count[b].
+void AddPlane(std::array<uint64_t, 4> &count, uint64_t plane) {
+  for (uint64_t &bit : count) {
+    uint64_t carry = bit & plane;
+    bit ^= plane;
+    plane = carry;
+  }
+}
+
+// Mask of the cells whose bit-sliced count is at least k.
+uint64_t AtLeast(const std::array<uint64_t, 4> &count, int k) {
+  if (k <= 0) return ~uint64_t(0);
+  if (k > 8) return 0;
+  uint64_t greater = 0;
+  uint64_t equal = ~uint64_t(0);
+  for (int b = 3; b >= 0; --b) {
+    uint64_t want = (k >> b) & 1 ? ~uint64_t(0) : 0;
+    greater |= equal & count[b] & ~want;
+    equal &= ~(count[b] ^ want);
+  }
+  return greater | equal;
+}
+
+// One SolveCave step over whole rows. Cells outside the cave count as
+// alive, so the missing row above or below is all ones and a shifted row
+// brings in a live bit at the edge.
+void StepRows(const uint64_t *from, uint64_t *to, int rows, int cols,
+              int birth, int death) {
+  const uint64_t mask = (uint64_t(1) << cols) - 1;
+  const uint64_t edge = uint64_t(1) << (cols - 1);
+  for (int i = 0; i < rows; ++i) {
+    uint64_t above = i > 0 ? from[i - 1] & mask : mask;
+    uint64_t middle = from[i] & mask;
+    uint64_t below = i + 1 < rows ? from[i + 1] & mask : mask;
+    std::array<uint64_t, 4> count{};
+    for (uint64_t row : {above, middle, below}) {
+      AddPlane(count, ((row << 1) | 1) & mask);
+      AddPlane(count, (row >> 1) | edge);
+    }
+    AddPlane(count, above);
+    AddPlane(count, below);
+    to[i] = ((middle & AtLeast(count, death)) |
+             (~middle & AtLeast(count, birth + 1))) &
+            mask;
+  }
+}
+
+// One SolveCaveRadius step. Neighbour counts come from a summed-area table
+// of the cave padded by radius live cells on every side, so each cell costs
+// four lookups whatever the radius. The table is kept per thread and only
+// grows.
+void StepRowsRadius(const uint64_t *from, uint64_t *to, int rows, int cols,
+                    int birth, int death, int radius) {
+  const int height = rows + 2 * radius;
+  const int width = cols + 2 * radius;
+  const int stride = width + 1;
+  static thread_local std::vector<int> sums;
+  sums.resize((height + 1) * stride);
+  std::fill(sums.begin(), sums.begin() + stride, 0);
+  for (int p = 0; p < height; ++p) {
+    int i = p - radius;
+    int row_sum = 0;
+    sums[(p + 1) * stride] = 0;
+    for (int q = 0; q < width; ++q) {
+      int j = q - radius;
+      bool inside = i >= 0 && i < rows && j >= 0 && j < cols;
+      row_sum += inside ? Maze::GetBit(from[i], j) : 1;
+      sums[(p + 1) * stride + q + 1] = sums[p * stride + q + 1] + row_sum;
+    }
+  }
+
+  const int side = 2 * radius + 1;
+  for (int i = 0; i < rows; ++i) {
+    uint64_t row = 0;
+    const int *top = &sums[i * stride];
+    const int *bottom = &sums[(i + side) * stride];
+    for (int j = 0; j < cols; ++j) {
+      int alive = Maze::GetBit(from[i], j);
+      int sum = bottom[j + side] - top[j + side] - bottom[j] + top[j] - alive;
+      if (alive ? sum >= death : sum > birth) row |= uint64_t(1) << j;
+    }
+    to[i] = row;
+  }
+}
+
+uint64_t HashRows(const uint64_t *rows, int count) {
+  uint64_t hash = 0x9e3779b97f4a7c15;
+  for (int i = 0; i < count; ++i) {
+    hash = (hash ^ rows[i]) * 0xff51afd7ed558ccd;
+    hash ^= hash >> 32;
+  }
+  return hash;
+}
+}  // namespace
+
 void Maze::GenerateCave(const double chance) {
   for (int i = 0; i < _rows; ++i)
     for (int j = 0; j < _cols; ++j)
@@ -8,7 +110,12 @@ void Maze::GenerateCave(const double chance) {
 }
 
 bool Maze::SolveCave(const int birth, const int death) {
-  bool result = true;
+  uint64_t changed;
+  return SolveCave(birth, death, changed);
+}
+
+bool Maze::SolveCave(const int birth, const int death, uint64_t &changed) {
+  changed = 0;
   for (int i = 0; i < _rows; ++i) {
     for (int j = 0; j < _cols; ++j) {
       if (GetBit(_verticals[i], j))
@@ -16,10 +123,171 @@ bool Maze::SolveCave(const int birth, const int death) {
       else
         ProceedDead(i, j, birth);
     }
-    result = result && (_verticals[i] == _horizontals[i]);
+    if (_verticals[i] != _horizontals[i]) SetBit1(changed, i);
   }
   std::swap(_verticals, _horizontals);
-  return result;
+  return changed == 0;
+}
+
+bool Maze::SolveCaveRadius(const int birth, const int death,
+                           const int radius) {
+  uint64_t changed;
+  return SolveCaveRadius(birth, death, radius, changed);
+}
+
+bool Maze::SolveCaveRadius(const int birth, const int death, const int radius,
+                           uint64_t &changed) {
+  if (radius < 1 || radius > kMaxSize)
+    throw std::invalid_argument("Invalid neighbourhood radius");
+  StepRowsRadius(_verticals.data(), _horizontals.data(), _rows, _cols, birth,
+                 death, radius);
+  changed = 0;
+  for (int i = 0; i < _rows; ++i) {
+    if (_verticals[i] != _horizontals[i]) SetBit1(changed, i);
+  }
+  std::swap(_verticals, _horizontals);
+  return changed == 0;
+}
+
+// Labels are keyed by the cave words, so any change to the cave, by a step
+// or otherwise, relabels on the next call. Callers share ownership, so a
+// relabel never frees labels that are still held.
+std::shared_ptr<const CaveRegions> Maze::Regions() const {
+  std::lock_guard<std::mutex> lock(_regions_mutex);
+  if (!_regions || !_regions->Matches(*this))
+    _regions = std::make_shared<const CaveRegions>(*this);
+  return _regions;
+}
+
+// Small regions are filled a row word at a time from the labels. The kept
+// regions are then joined greedily: a 0-1 BFS from the connected part, where
+// entering a live cell costs 1, reaches the nearest other region through the
+// fewest live cells, and those cells are carved. Carving works per cell and
+// reruns the full-grid search for every region it joins; caves have few
+// kept regions after filling, so this stays cheap next to the steps.
+int Maze::ConnectCave(int min_region_size) {
+  const std::shared_ptr<const CaveRegions> labelled = Regions();
+  const CaveRegions &regions = *labelled;
+  if (regions.Count() == 0) return 0;
+  int largest = 0;
+  for (int i = 1; i < regions.Count(); ++i)
+    if (regions.Size(i) > regions.Size(largest)) largest = i;
+
+  std::vector<bool> kept(regions.Count());
+  for (int i = 0; i < regions.Count(); ++i)
+    kept[i] = i == largest || regions.Size(i) >= min_region_size;
+  std::vector<uint16_t> labels(_rows * _cols);
+  for (int i = 0; i < _rows; ++i) {
+    uint64_t fill = 0;
+    for (int j = 0; j < _cols; ++j) {
+      labels[i * _cols + j] = regions.Region({i, j});
+      if (labels[i * _cols + j] != CaveRegions::kSolid &&
+          !kept[labels[i * _cols + j]])
+        SetBit1(fill, j);
+    }
+    _verticals[i] |= fill;
+  }
+
+  std::vector<bool> joined(regions.Count());
+  joined[largest] = true;
+  int remaining = 0;
+  for (int i = 0; i < regions.Count(); ++i)
+    remaining += kept[i] && !joined[i];
+
+  const std::array<Cell, 4> delta = {{{-1, 0}, {1, 0}, {0, 1}, {0, -1}}};
+  std::vector<int> cost(_rows * _cols);
+  std::vector<int> prev(_rows * _cols);
+  int carved = 0;
+  for (; remaining > 0; --remaining) {
+    std::deque<int> queue;
+    std::fill(cost.begin(), cost.end(), INT32_MAX);
+    for (int k = 0; k < _rows * _cols; ++k) {
+      if (labels[k] != CaveRegions::kSolid && joined[labels[k]]) {
+        cost[k] = 0;
+        prev[k] = k;
+        queue.push_back(k);
+      }
+    }
+    int target;
+    for (;;) {
+      int k = queue.front();
+      queue.pop_front();
+      if (labels[k] != CaveRegions::kSolid && !joined[labels[k]] &&
+          kept[labels[k]]) {
+        target = k;
+        break;
+      }
+      Cell cell{k / _cols, k % _cols};
+      for (const Cell &d : delta) {
+        Cell next = cell + d;
+        if (!ValidPoint(next)) continue;
+        int n = next.r * _cols + next.c;
+        bool open = !GetBit(_verticals[next.r], next.c);
+        if (cost[k] + !open < cost[n]) {
+          cost[n] = cost[k] + !open;
+          prev[n] = k;
+          open ? queue.push_front(n) : queue.push_back(n);
+        }
+      }
+    }
+    for (int k = prev[target]; cost[k] > 0; k = prev[k]) {
+      if (GetBit(_verticals[k / _cols], k % _cols)) {
+        SetBit0(_verticals[k / _cols], k % _cols);
+        ++carved;
+      }
+      labels[k] = largest;
+    }
+    joined[labels[target]] = true;
+  }
+  return carved;
+}
+
+int Maze::SolveCaveSteps(const int birth, const int death, const int steps,
+                         bool &stable) {
+  stable = false;
+  int done = 0;
+  while (done < steps && !stable) {
+    stable = SolveCave(birth, death);
+    ++done;
+  }
+  return done;
+}
+
+// Steps ping-pong between the two row arrays, through the bit-sliced kernel
+// for radius 1 and the summed-area one otherwise. Every generation is kept
+// by hash so that a repeat, confirmed against the stored rows, ends the run
+// with the cycle's period; period 1 is a still cave.
+CaveRun Maze::RunCaveToStable(const int birth, const int death,
+                              const int max_steps, const int radius) {
+  if (radius < 1 || radius > kMaxSize)
+    throw std::invalid_argument("Invalid neighbourhood radius");
+  CaveRun run{0, 0};
+  uint64_t *from = _verticals.data();
+  uint64_t *to = _horizontals.data();
+  // Steps only write bits inside the cave, so the start must not carry any
+  // outside it or a return to it would hash differently.
+  const uint64_t mask = (uint64_t(1) << _cols) - 1;
+  for (int i = 0; i < _rows; ++i) from[i] &= mask;
+  std::vector<uint64_t> history(from, from + _rows);
+  std::unordered_multimap<uint64_t, int> seen;
+  seen.emplace(HashRows(from, _rows), 0);
+  while (run.steps < max_steps && run.period == 0) {
+    if (radius == 1)
+      StepRows(from, to, _rows, _cols, birth, death);
+    else
+      StepRowsRadius(from, to, _rows, _cols, birth, death, radius);
+    std::swap(from, to);
+    ++run.steps;
+    uint64_t hash = HashRows(from, _rows);
+    auto [first, last] = seen.equal_range(hash);
+    for (auto it = first; it != last && run.period == 0; ++it)
+      if (std::equal(from, from + _rows, history.begin() + it->second * _rows))
+        run.period = run.steps - it->second;
+    seen.emplace(hash, run.steps);
+    history.insert(history.end(), from, from + _rows);
+  }
+  if (from != _verticals.data()) std::swap(_verticals, _horizontals);
+  return run;
 }
 
 void Maze::ProceedAlive(const int i, const int j, const int death) {
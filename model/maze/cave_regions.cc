@@ -0,0 +1,70 @@
+#include "cave_regions.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+struct Run {
+  int row;
+  int start;
+  int length;
+  uint64_t mask;
+};
+
+int Find(std::vector<int>& parent, int x) {
+  while (parent[x] != x) x = parent[x] = parent[parent[x]];
+  return x;
+}
+}  // namespace
+
+CaveRegions::CaveRegions(const Maze& cave)
+    : m_rows_(cave.GetRows()),
+      m_cols_(cave.GetCols()),
+      m_cells_(cave.GetVerticals()),
+      m_labels_(m_rows_ * m_cols_, kSolid) {
+  uint64_t row_mask = m_cols_ >= 64 ? ~0ULL : (1ULL << m_cols_) - 1;
+  std::vector<Run> runs;
+  std::vector<int> parent;
+  size_t previous = 0;  // first run of the row above
+  for (int i = 0; i < m_rows_; ++i) {
+    size_t current = runs.size();
+    size_t above = previous;
+    uint64_t open = ~m_cells_[i] & row_mask;
+    while (open) {
+      int start = std::countr_zero(open);
+      int length = std::countr_one(open >> start);
+      uint64_t mask = ((1ULL << length) - 1) << start;
+      open &= ~mask;
+      int id = static_cast<int>(runs.size());
+      runs.push_back({i, start, length, mask});
+      parent.push_back(id);
+      // Both rows' runs are sorted by column: runs above that end before
+      // this one cannot touch later ones either.
+      while (above < current && !(runs[above].mask >> start)) ++above;
+      for (size_t k = above; k < current && runs[k].start < start + length;
+           ++k) {
+        parent[Find(parent, id)] = Find(parent, static_cast<int>(k));
+      }
+    }
+    previous = current;
+  }
+
+  std::vector<int> region(runs.size(), -1);
+  for (size_t k = 0; k < runs.size(); ++k) {
+    int root = Find(parent, static_cast<int>(k));
+    if (region[root] < 0) {
+      region[root] = static_cast<int>(m_sizes_.size());
+      m_sizes_.push_back(0);
+    }
+    const Run& run = runs[k];
+    m_sizes_[region[root]] += run.length;
+    std::fill_n(m_labels_.begin() + run.row * m_cols_ + run.start, run.length,
+                static_cast<uint16_t>(region[root]));
+  }
+}
+
+bool CaveRegions::Matches(const Maze& cave) const {
+  if (cave.GetRows() != m_rows_ || cave.GetCols() != m_cols_) return false;
+  auto cells = cave.GetVerticals();
+  return std::equal(cells.begin(), cells.begin() + m_rows_, m_cells_.begin());
+}
@@ -0,0 +1,38 @@
+#ifndef CAVE_REGIONS_H_
+#define CAVE_REGIONS_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "maze.h"
+
+// 4-connected regions of the dead (open) cells of a cave. Labeling works on
+// runs of open cells: each row's runs are found from the row word, joined
+// with the overlapping runs of the row above by union-find, and the roots
+// are then numbered in row-major order.
+class CaveRegions {
+ public:
+  static constexpr uint16_t kSolid = UINT16_MAX;
+
+  explicit CaveRegions(const Maze& cave);
+
+  bool Matches(const Maze& cave) const;
+  int Count() const { return static_cast<int>(m_sizes_.size()); }
+  int Size(int region) const { return m_sizes_[region]; }
+  uint16_t Region(Cell cell) const {
+    return m_labels_[cell.r * m_cols_ + cell.c];
+  }
+  bool Connected(Cell a, Cell b) const {
+    return Region(a) != kSolid && Region(a) == Region(b);
+  }
+
+ private:
+  int m_rows_;
+  int m_cols_;
+  std::array<uint64_t, kMaxSize> m_cells_;  // words labeled
+  std::vector<uint16_t> m_labels_;          // per cell, row-major
+  std::vector<int> m_sizes_;
+};
+
+#endif  // CAVE_REGIONS_H_
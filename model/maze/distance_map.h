@@ -0,0 +1,30 @@
+#ifndef DISTANCE_MAP_H_
+#define DISTANCE_MAP_H_
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../cell.h"
+
+// Breadth-first distances from one cell. Cells are stored level by level in
+// one array; level i is cells[offsets[i], offsets[i + 1]).
+struct DistanceMap {
+  static constexpr uint32_t kUnreachable = UINT32_MAX;
+
+  int rows = 0;
+  int cols = 0;
+  std::vector<uint32_t> distance;  // per cell, row-major
+  std::vector<Cell> cells;
+  std::vector<uint32_t> offsets;
+
+  size_t Levels() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+  std::span<const Cell> Level(size_t i) const {
+    return {cells.data() + offsets[i], cells.data() + offsets[i + 1]};
+  }
+  uint32_t Distance(Cell cell) const {
+    return distance[cell.r * cols + cell.c];
+  }
+};
+
+#endif  // DISTANCE_MAP_H_
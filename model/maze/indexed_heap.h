@@ -0,0 +1,76 @@
+#ifndef INDEXED_HEAP_H_
+#define INDEXED_HEAP_H_
+
+#include <array>
+#include <cstdint>
+
+#include "maze.h"
+
+// Binary min-heap of cell indices with decrease-key. Positions are not
+// cleared between searches; an entry only counts if the item at its
+// position points back at it.
+class IndexedHeap {
+ public:
+  static constexpr int kCells = kMaxSize * kMaxSize;
+
+  IndexedHeap() : m_items_(), m_positions_(), m_size_(0) {}
+
+  void Clear() { m_size_ = 0; }
+  bool Empty() const { return m_size_ == 0; }
+  bool Contains(int id) const {
+    int pos = m_positions_[id];
+    return pos < m_size_ && m_items_[pos].id == id;
+  }
+
+  // Inserts id or lowers its key if it is already queued.
+  void Push(int id, uint32_t key) {
+    int pos = Contains(id) ? m_positions_[id] : m_size_++;
+    m_items_[pos] = {key, static_cast<uint16_t>(id)};
+    SiftUp(pos);
+  }
+
+  int Pop() {
+    int top = m_items_[0].id;
+    m_items_[0] = m_items_[--m_size_];
+    m_positions_[m_items_[0].id] = 0;
+    SiftDown(0);
+    return top;
+  }
+
+ private:
+  struct Item {
+    uint32_t key;
+    uint16_t id;
+  };
+
+  void SiftUp(int pos) {
+    Item item = m_items_[pos];
+    while (pos > 0 && item.key < m_items_[(pos - 1) / 2].key) {
+      m_items_[pos] = m_items_[(pos - 1) / 2];
+      m_positions_[m_items_[pos].id] = pos;
+      pos = (pos - 1) / 2;
+    }
+    m_items_[pos] = item;
+    m_positions_[item.id] = pos;
+  }
+
+  void SiftDown(int pos) {
+    Item item = m_items_[pos];
+    for (int child = 2 * pos + 1; child < m_size_; child = 2 * pos + 1) {
+      if (child + 1 < m_size_ && m_items_[child + 1].key < m_items_[child].key)
+        ++child;
+      if (m_items_[child].key >= item.key) break;
+      m_items_[pos] = m_items_[child];
+      m_positions_[m_items_[pos].id] = pos;
+      pos = child;
+    }
+    m_items_[pos] = item;
+    m_positions_[item.id] = pos;
+  }
+
+  std::array<Item, kCells> m_items_;
+  std::array<uint16_t, kCells> m_positions_;
+  int m_size_;
+};
+
+#endif  // INDEXED_HEAP_H_
@@ -1,11 +1,12 @@
 #include "maze.h"
 
-std::mt19937 Maze::_gen;
-std::uniform_int_distribution<> Maze::_dist_bit(0, 1);
-std::uniform_real_distribution<> Maze::_dist_real(0.0, 1.0);
+// Per thread, so that mazes can be generated and agents trained concurrently.
+thread_local std::mt19937 Maze::_gen;
+thread_local std::uniform_int_distribution<> Maze::_dist_bit(0, 1);
+thread_local std::uniform_real_distribution<> Maze::_dist_real(0.0, 1.0);
 
 void Maze::InitRandom() {
-  static bool initialized = false;
+  thread_local bool initialized = false;
   if (!initialized) {
     _gen.seed(std::random_device{}());
     initialized = true;
@@ -227,7 +228,10 @@ Maze::Maze(const Maze& other)
     : _rows(other._rows),
       _cols(other._cols),
       _verticals(other._verticals),
-      _horizontals(other._horizontals) {}
+      _horizontals(other._horizontals) {
+  std::lock_guard<std::mutex> lock(other._regions_mutex);
+  _regions = other._regions;
+}
 
 Maze& Maze::operator=(const Maze& other) noexcept {
   if (this != &other) {
@@ -235,6 +239,8 @@ Maze& Maze::operator=(const Maze& other) noexcept {
     _cols = other._cols;
     _verticals = other._verticals;
     _horizontals = other._horizontals;
+    std::scoped_lock lock(_regions_mutex, other._regions_mutex);
+    _regions = other._regions;
   }
   return *this;
 }
@@ -243,7 +249,8 @@ Maze::Maze(Maze&& other) noexcept
     : _rows(other._rows),
       _cols(other._cols),
       _verticals(std::move(other._verticals)),
-      _horizontals(std::move(other._horizontals)) {
+      _horizontals(std::move(other._horizontals)),
+      _regions(std::move(other._regions)) {
   other._rows = 0;
   other._cols = 0;
 }
@@ -254,6 +261,7 @@ Maze& Maze::operator=(Maze&& other) noexcept {
     _cols = other._cols;
     _verticals = std::move(other._verticals);
     _horizontals = std::move(other._horizontals);
+    _regions = std::move(other._regions);
     other._rows = 0;
     other._cols = 0;
   }
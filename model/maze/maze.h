@@ -6,17 +6,31 @@
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "../cell.h"
+#include "distance_map.h"
 
 constexpr int kMaxSize = 50;
 // class QLearning;
+class SolverWorkspace;
+class CaveRegions;
+
+// kJumpPoint is for SolveCavePath only; SolveMaze rejects it.
+enum class SearchMode { kBreadthFirst, kBidirectional, kAStar, kJumpPoint };
+
+struct CaveRun {
+  int steps;   // steps performed
+  int period;  // 1 if stable, p if cycling with period p, 0 if not settled
+};
 
 class Maze {
   friend class QLearning;
@@ -32,8 +46,31 @@ class Maze {
   void GenerateMaze();
   void GenerateCave(const double chance);
   bool SolveCave(const int birth, const int death);
-  std::vector<Cell> SolveMaze(Cell end, Cell start);
-  std::vector<std::vector<Cell>> DistanceMatrix(Cell start);
+  bool SolveCave(const int birth, const int death, uint64_t &changed);
+  bool SolveCaveRadius(const int birth, const int death, const int radius);
+  bool SolveCaveRadius(const int birth, const int death, const int radius,
+                       uint64_t &changed);
+  int SolveCaveSteps(const int birth, const int death, const int steps,
+                     bool &stable);
+  CaveRun RunCaveToStable(const int birth, const int death,
+                          const int max_steps, const int radius = 1);
+  int ConnectCave(int min_region_size);
+  std::vector<Cell> SolveMaze(Cell end, Cell start,
+                              SearchMode mode = SearchMode::kBreadthFirst);
+  bool SolveMaze(Cell end, Cell start, std::vector<Cell> &pass,
+                 SearchMode mode = SearchMode::kBreadthFirst);
+  bool SolveMaze(Cell end, Cell start, std::vector<Cell> &pass,
+                 SolverWorkspace &workspace,
+                 SearchMode mode = SearchMode::kBreadthFirst) const;
+  std::vector<std::vector<Cell>> SolveMazeBatch(
+      const std::vector<std::pair<Cell, Cell>> &queries,
+      unsigned threads = 1) const;
+  std::vector<Cell> SolveCavePath(
+      Cell end, Cell start, SearchMode mode = SearchMode::kJumpPoint) const;
+  bool SolveCavePath(Cell end, Cell start, std::vector<Cell> &pass,
+                     SearchMode mode = SearchMode::kJumpPoint) const;
+  DistanceMap DistanceMatrix(Cell start) const;
+  std::shared_ptr<const CaveRegions> Regions() const;
   bool Load(std::istream &stream, char c);
   bool Save(std::ostream &stream, char c) const;
   int GetRows() const { return _rows; }
@@ -51,7 +88,7 @@ class Maze {
   };
   bool SetRowsCols(int rows, int cols);
   static void InitRandom();
-  static std::mt19937 _gen;
+  static thread_local std::mt19937 _gen;
 
  private:
   bool LoadMatrix(std::istream &stream, char c);
@@ -85,6 +122,14 @@ class Maze {
   }
 
   static bool EmptyPoint(const Cell &point);
+  void BuildPathTree(Cell root, std::vector<Cell> &prev) const;
+  bool SolveBidirectional(Cell end, Cell start, std::vector<Cell> &pass,
+                          SolverWorkspace &workspace) const;
+  bool SolveAStar(Cell end, Cell start, std::vector<Cell> &pass) const;
+  bool Jump(Cell from, int direction, Cell end, Cell &out) const;
+  bool OpenCell(const Cell &cell) const {
+    return ValidPoint(cell) && !GetBit(_verticals[cell.r], cell.c);
+  }
   void ProceedDead(const int i, const int j, const int birth);
   void ProceedAlive(const int i, const int j, const int death);
 
@@ -92,9 +137,11 @@ class Maze {
   int _cols;
   std::array<uint64_t, kMaxSize> _verticals;
   std::array<uint64_t, kMaxSize> _horizontals;
+  mutable std::shared_ptr<const CaveRegions> _regions;
+  mutable std::mutex _regions_mutex;  // guards _regions, not the cells
 
-  static std::uniform_int_distribution<> _dist_bit;
-  static std::uniform_real_distribution<> _dist_real;
+  static thread_local std::uniform_int_distribution<> _dist_bit;
+  static thread_local std::uniform_real_distribution<> _dist_real;
 
   static int RandomBit() { return _dist_bit(_gen); }
   static double RandomReal() { return _dist_real(_gen); }
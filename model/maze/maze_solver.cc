@@ -1,64 +1,225 @@
+#include <algorithm>
+#include <thread>
+
 #include "maze.h"
+#include "solver_workspace.h"
 
 bool Maze::EmptyPoint(const Cell& point) {
   return point.r == -1 && point.c == -1;
 }
 
-std::vector<Cell> Maze::SolveMaze(Cell end, Cell start) {
-  std::vector<std::vector<Cell>> prev(_rows,
-                                      std::vector<Cell>(_cols, {-1, -1}));
+namespace {
+const std::array<Cell, 4> kSteps = {{{-1, 0}, {1, 0}, {0, 1}, {0, -1}}};
 
-  const std::array<Cell, 4> d = {{{-1, 0}, {1, 0}, {0, 1}, {0, -1}}};
-  std::queue<Cell> q;
-  q.push(start);
-  prev[start.r][start.c] = start;
+// A visited cell's predecessor is one step against the way it was entered.
+Cell StepBack(const SolverWorkspace& workspace, Cell cell) {
+  Cell step = kSteps[workspace.Direction(cell.r * kMaxSize + cell.c)];
+  return {cell.r - step.r, cell.c - step.c};
+}
+
+size_t ChainLength(const SolverWorkspace& workspace, Cell from, Cell to) {
+  size_t length = 1;
+  for (; from != to; from = StepBack(workspace, from)) ++length;
+  return length;
+}
+}  // namespace
+
+std::vector<Cell> Maze::SolveMaze(Cell end, Cell start, SearchMode mode) {
+  std::vector<Cell> pass;
+  SolveMaze(end, start, pass, mode);
+  return pass;
+}
+
+bool Maze::SolveMaze(Cell end, Cell start, std::vector<Cell>& pass,
+                     SearchMode mode) {
+  static thread_local SolverWorkspace workspace;
+  return SolveMaze(end, start, pass, workspace, mode);
+}
+
+bool Maze::SolveMaze(Cell end, Cell start, std::vector<Cell>& pass,
+                     SolverWorkspace& workspace, SearchMode mode) const {
+  if (mode == SearchMode::kBidirectional)
+    return SolveBidirectional(end, start, pass, workspace);
+  if (mode == SearchMode::kJumpPoint)
+    throw std::invalid_argument("Jump point search is for caves only");
+  if (mode == SearchMode::kAStar) return SolveAStar(end, start, pass);
+  workspace.Reset();
+  workspace.Visit(start.r * kMaxSize + start.c, 0);
+  workspace.Push(start.r * kMaxSize + start.c);
   bool found = false;
-  while (!q.empty() && !found) {
-    Cell current = q.front();
-    q.pop();
+  while (!workspace.Empty() && !found) {
+    int index = workspace.Pop();
+    Cell current{index / kMaxSize, index % kMaxSize};
     if (current == end)
       found = true;
     else {
       for (int i = 0; i < 4; ++i) {
-        Cell tmp = current + d[i];
-        if (CanGo(current, tmp) && EmptyPoint(prev[tmp.r][tmp.c])) {
-          prev[tmp.r][tmp.c] = current;
-          q.push(tmp);
+        Cell tmp = current + kSteps[i];
+        int next = tmp.r * kMaxSize + tmp.c;
+        if (CanGo(current, tmp) && !workspace.Visited(next)) {
+          workspace.Visit(next, i);
+          workspace.Push(next);
         }
       }
     }
   }
-  std::vector<Cell> pass;
-  if (found) {
+  pass.clear();
+  if (!found) return false;
+  // Measure first so the buffer grows at most once.
+  size_t length = ChainLength(workspace, end, start);
+  pass.resize(length);
+  pass[0] = end;
+  for (size_t i = 1; i < length; ++i)
+    pass[i] = StepBack(workspace, pass[i - 1]);
+  return true;
+}
+
+// Side 0 grows from start and side 1 from end, one whole level of the
+// smaller frontier at a time. The first edge between the sides closes a
+// shortest path: a shorter one would have met while expanding an earlier
+// level.
+bool Maze::SolveBidirectional(Cell end, Cell start, std::vector<Cell>& pass,
+                              SolverWorkspace& workspace) const {
+  pass.clear();
+  workspace.Reset();
+  if (start == end) {
     pass.push_back(end);
-    while (pass.back() != start) {
-      pass.push_back(prev[pass.back().r][pass.back().c]);
+    return true;
+  }
+  const std::array<Cell, 2> roots = {start, end};
+  for (int side = 0; side < 2; ++side) {
+    workspace.Visit(roots[side].r * kMaxSize + roots[side].c, 0, side);
+    workspace.Push(roots[side].r * kMaxSize + roots[side].c, side);
+  }
+  std::array<Cell, 2> meet{};
+  bool found = false;
+  while (!found && !workspace.Empty(0) && !workspace.Empty(1)) {
+    int side = workspace.Size(0) <= workspace.Size(1) ? 0 : 1;
+    for (int n = workspace.Size(side); n > 0 && !found; --n) {
+      int index = workspace.Pop(side);
+      Cell current{index / kMaxSize, index % kMaxSize};
+      for (int i = 0; i < 4 && !found; ++i) {
+        Cell tmp = current + kSteps[i];
+        int next = tmp.r * kMaxSize + tmp.c;
+        if (!CanGo(current, tmp)) continue;
+        if (!workspace.Visited(next)) {
+          workspace.Visit(next, i, side);
+          workspace.Push(next, side);
+        } else if (workspace.Side(next) != side) {
+          meet[side] = current;
+          meet[1 - side] = tmp;
+          found = true;
+        }
+      }
     }
   }
-  return pass;
+  if (!found) return false;
+  // end ... meet[1] comes from walking side 1 back to end, reversed.
+  size_t tail = ChainLength(workspace, meet[1], end);
+  pass.resize(tail + ChainLength(workspace, meet[0], start));
+  pass[tail - 1] = meet[1];
+  for (size_t i = tail - 1; i > 0; --i)
+    pass[i - 1] = StepBack(workspace, pass[i]);
+  pass[tail] = meet[0];
+  for (size_t i = tail + 1; i < pass.size(); ++i)
+    pass[i] = StepBack(workspace, pass[i - 1]);
+  return true;
+}
+
+// Queries sharing a BFS root reuse one predecessor tree; the trees are split
+// between threads. The tree is filled in the same order as SolveMaze, so each
+// path equals SolveMaze(end, start).
+std::vector<std::vector<Cell>> Maze::SolveMazeBatch(
+    const std::vector<std::pair<Cell, Cell>>& queries, unsigned threads) const {
+  std::vector<std::vector<Cell>> passes(queries.size());
+  std::vector<std::vector<size_t>> by_root(kMaxSize * kMaxSize);
+  std::vector<int> roots;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const auto& [end, start] = queries[i];
+    if (!ValidPoint(end) || !ValidPoint(start)) continue;
+    auto& group = by_root[start.r * kMaxSize + start.c];
+    if (group.empty()) roots.push_back(start.r * kMaxSize + start.c);
+    group.push_back(i);
+  }
+
+  auto worker = [&](size_t first, size_t step) {
+    std::vector<Cell> prev;
+    for (size_t k = first; k < roots.size(); k += step) {
+      Cell root{roots[k] / kMaxSize, roots[k] % kMaxSize};
+      BuildPathTree(root, prev);
+      for (size_t i : by_root[roots[k]]) {
+        Cell cell = queries[i].first;
+        if (EmptyPoint(prev[cell.r * _cols + cell.c])) continue;
+        auto& pass = passes[i];
+        pass.push_back(cell);
+        while (cell != root) {
+          cell = prev[cell.r * _cols + cell.c];
+          pass.push_back(cell);
+        }
+      }
+    }
+  };
+
+  size_t count = std::min<size_t>(std::max(threads, 1u), roots.size());
+  if (count <= 1) {
+    worker(0, 1);
+    return passes;
+  }
+  std::vector<std::thread> pool;
+  pool.reserve(count - 1);
+  for (size_t t = 1; t < count; ++t) pool.emplace_back(worker, t, count);
+  worker(0, count);
+  for (auto& thread : pool) thread.join();
+  return passes;
 }
 
-std::vector<std::vector<Cell>> Maze::DistanceMatrix(Cell start) {
-  std::vector<std::vector<Cell>> matrix{};
-  std::vector<std::vector<bool>> visited(_rows,
-                                         std::vector<bool>(_cols, false));
+void Maze::BuildPathTree(Cell root, std::vector<Cell>& prev) const {
+  prev.assign(_rows * _cols, {-1, -1});
+  const std::array<Cell, 4> d = {{{-1, 0}, {1, 0}, {0, 1}, {0, -1}}};
+  std::queue<Cell> q;
+  q.push(root);
+  prev[root.r * _cols + root.c] = root;
+  while (!q.empty()) {
+    Cell current = q.front();
+    q.pop();
+    for (int i = 0; i < 4; ++i) {
+      Cell tmp = current + d[i];
+      if (CanGo(current, tmp) && EmptyPoint(prev[tmp.r * _cols + tmp.c])) {
+        prev[tmp.r * _cols + tmp.c] = current;
+        q.push(tmp);
+      }
+    }
+  }
+}
+
+// The BFS queue is the cell array itself; a level ends where the previous
+// level's neighbours stop being appended.
+DistanceMap Maze::DistanceMatrix(Cell start) const {
+  DistanceMap map;
+  map.rows = _rows;
+  map.cols = _cols;
+  if (!ValidPoint(start)) return map;
+  map.distance.assign(_rows * _cols, DistanceMap::kUnreachable);
+  map.cells.reserve(_rows * _cols);
   const std::array<Cell, 4> delta = {{{-1, 0}, {1, 0}, {0, 1}, {0, -1}}};
-  int i = 0;
-  matrix.push_back({start});
-  visited[start.r][start.c] = true;
-  while (!matrix[i].empty()) {
-    std::vector<Cell> next_level;
-    for (auto m : matrix[i]) {
+  map.cells.push_back(start);
+  map.distance[start.r * _cols + start.c] = 0;
+  map.offsets.push_back(0);
+  uint32_t level = 0;
+  for (size_t head = 0; head < map.cells.size(); ++level) {
+    size_t end = map.cells.size();
+    map.offsets.push_back(end);
+    for (; head < end; ++head) {
+      Cell m = map.cells[head];
       for (auto d : delta) {
         Cell tmp = m + d;
-        if (CanGo(m, tmp) && !visited[tmp.r][tmp.c]) {
-          visited[tmp.r][tmp.c] = true;
-          next_level.push_back(tmp);
+        if (CanGo(m, tmp) &&
+            map.distance[tmp.r * _cols + tmp.c] == DistanceMap::kUnreachable) {
+          map.distance[tmp.r * _cols + tmp.c] = level + 1;
+          map.cells.push_back(tmp);
         }
       }
     }
-    matrix.push_back(next_level);
-    ++i;
   }
-  return matrix;
-}
\ No newline at end of file
+  return map;
+}
@@ -0,0 +1,169 @@
+#include <cstdlib>
+
+#include "indexed_heap.h"
+#include "maze.h"
+
+namespace {
+const std::array<Cell, 4> kSteps = {{{-1, 0}, {1, 0}, {0, 1}, {0, -1}}};
+constexpr int kAllDirections = 4;
+
+int Index(Cell cell) { return cell.r * kMaxSize + cell.c; }
+Cell CellAt(int index) { return {index / kMaxSize, index % kMaxSize}; }
+int Manhattan(Cell a, Cell b) {
+  return std::abs(a.r - b.r) + std::abs(a.c - b.c);
+}
+
+// Per-thread A* bookkeeping; a cell's data is valid only when its stamp is
+// the current generation (open) or the one after it (closed).
+struct AStarState {
+  IndexedHeap open;
+  std::array<uint32_t, kMaxSize * kMaxSize> stamps{};
+  std::array<uint32_t, kMaxSize * kMaxSize> g{};
+  std::array<uint16_t, kMaxSize * kMaxSize> parent{};
+  std::array<uint8_t, kMaxSize * kMaxSize> direction{};
+  uint32_t generation = 0;
+
+  void Reset() {
+    open.Clear();
+    generation += 2;
+    if (generation == 0) {
+      stamps.fill(0);
+      generation = 2;
+    }
+  }
+  bool Seen(int index) const { return stamps[index] >= generation; }
+  bool Closed(int index) const { return stamps[index] == generation + 1; }
+};
+
+AStarState& State() {
+  static thread_local AStarState state;
+  return state;
+}
+
+// Ties on f prefer the node closer to the goal.
+uint32_t Key(uint32_t g, int h) { return ((g + h) << 12) | h; }
+
+// Runs A* from start. expand(cell, direction, relax) calls relax(next, i)
+// for each successor, where direction is how cell was entered and i how
+// next is; successors may be several cells away in a straight line (jump
+// points), so the path is filled in along the segments.
+template <typename Expand>
+bool RunAStar(Cell end, Cell start, std::vector<Cell>& pass, Expand expand) {
+  AStarState& state = State();
+  state.Reset();
+  pass.clear();
+  int goal = Index(end);
+  int root = Index(start);
+  state.stamps[root] = state.generation;
+  state.g[root] = 0;
+  state.parent[root] = root;
+  state.direction[root] = kAllDirections;
+  state.open.Push(root, Key(0, Manhattan(start, end)));
+
+  bool found = false;
+  while (!state.open.Empty()) {
+    int index = state.open.Pop();
+    state.stamps[index] = state.generation + 1;
+    if (index == goal) {
+      found = true;
+      break;
+    }
+    Cell current = CellAt(index);
+    expand(current, state.direction[index],
+           [&](Cell next, int direction) {
+             int next_index = Index(next);
+             if (state.Closed(next_index)) return;
+             uint32_t g = state.g[index] + Manhattan(current, next);
+             if (state.Seen(next_index) && state.g[next_index] <= g) return;
+             state.stamps[next_index] = state.generation;
+             state.g[next_index] = g;
+             state.parent[next_index] = index;
+             state.direction[next_index] = direction;
+             state.open.Push(next_index, Key(g, Manhattan(next, end)));
+           });
+  }
+  if (!found) return false;
+
+  pass.resize(state.g[goal] + 1);
+  size_t i = 0;
+  for (int index = goal; index != root; index = state.parent[index]) {
+    Cell from = CellAt(index);
+    Cell to = CellAt(state.parent[index]);
+    Cell step{(to.r > from.r) - (to.r < from.r),
+              (to.c > from.c) - (to.c < from.c)};
+    for (Cell cell = from; cell != to; cell = cell + step) pass[i++] = cell;
+  }
+  pass[i] = start;
+  return true;
+}
+}  // namespace
+
+bool Maze::SolveAStar(Cell end, Cell start, std::vector<Cell>& pass) const {
+  return RunAStar(end, start, pass, [this](Cell current, int, auto&& relax) {
+    for (int i = 0; i < 4; ++i) {
+      Cell next = current + kSteps[i];
+      if (CanGo(current, next)) relax(next, i);
+    }
+  });
+}
+
+std::vector<Cell> Maze::SolveCavePath(Cell end, Cell start,
+                                      SearchMode mode) const {
+  std::vector<Cell> pass;
+  SolveCavePath(end, start, pass, mode);
+  return pass;
+}
+
+// Jump point search keeps, among equal-length paths, the ones that move
+// horizontally before turning vertically. A horizontal arrival may continue
+// or turn up or down; a vertical one continues, and turns sideways only
+// where the side cell is open but the one behind it is not.
+bool Maze::SolveCavePath(Cell end, Cell start, std::vector<Cell>& pass,
+                         SearchMode mode) const {
+  pass.clear();
+  if (!OpenCell(start) || !OpenCell(end)) return false;
+  if (mode != SearchMode::kJumpPoint) {
+    return RunAStar(end, start, pass, [this](Cell current, int, auto&& relax) {
+      for (int i = 0; i < 4; ++i) {
+        Cell next = current + kSteps[i];
+        if (OpenCell(next)) relax(next, i);
+      }
+    });
+  }
+  return RunAStar(
+      end, start, pass, [this, end](Cell current, int from, auto&& relax) {
+        for (int i = 0; i < 4; ++i) {
+          bool natural = from == kAllDirections || i == from ||
+                         (from >= 2 && i < 2);
+          if (!natural && from < 2 && i >= 2) {
+            Cell behind{current.r - kSteps[from].r, current.c};
+            natural = OpenCell(current + kSteps[i]) &&
+                      !OpenCell(behind + kSteps[i]);
+          }
+          Cell next;
+          if (natural && Jump(current, i, end, next)) relax(next, i);
+        }
+      });
+}
+
+bool Maze::Jump(Cell from, int direction, Cell end, Cell& out) const {
+  const Cell step = kSteps[direction];
+  for (Cell cell = from + step; OpenCell(cell); cell = cell + step) {
+    bool jump_point = cell == end;
+    if (!jump_point && direction < 2) {
+      for (int side = 2; side < 4 && !jump_point; ++side) {
+        Cell behind{cell.r - step.r, cell.c};
+        jump_point = OpenCell(cell + kSteps[side]) &&
+                     !OpenCell(behind + kSteps[side]);
+      }
+    } else if (!jump_point) {
+      Cell found;
+      jump_point = Jump(cell, 0, end, found) || Jump(cell, 1, end, found);
+    }
+    if (jump_point) {
+      out = cell;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,64 @@
+#ifndef SOLVER_WORKSPACE_H_
+#define SOLVER_WORKSPACE_H_
+
+#include <array>
+#include <cstdint>
+
+#include "maze.h"
+
+// Scratch state for one breadth-first search, reused across searches. Cells
+// are indexed r * kMaxSize + c. Visited marks are generation stamps, so
+// starting a search does not clear anything; each cell keeps the direction it
+// was entered from in 2 bits. A bidirectional search grows two sides, each
+// with its own queue, and the stamp tells which side reached a cell.
+class SolverWorkspace {
+ public:
+  static constexpr int kCells = kMaxSize * kMaxSize;
+
+  SolverWorkspace() : m_stamps_(), m_directions_(), m_queues_() {}
+
+  void Reset() {
+    m_heads_ = m_tails_ = {0, 0};
+    m_generation_ += 2;
+    if (m_generation_ == 0) {
+      m_stamps_.fill(0);
+      m_generation_ = 2;
+    }
+  }
+
+  bool Visited(int index) const { return m_stamps_[index] >= m_generation_; }
+  int Side(int index) const { return m_stamps_[index] - m_generation_; }
+  void Visit(int index, int direction, int side = 0) {
+    m_stamps_[index] = m_generation_ + side;
+    uint8_t& byte = m_directions_[index >> 2];
+    int shift = (index & 3) << 1;
+    byte = (byte & ~(3u << shift)) | (direction << shift);
+  }
+  int Direction(int index) const {
+    return (m_directions_[index >> 2] >> ((index & 3) << 1)) & 3;
+  }
+
+  // Each cell is pushed at most once per search, so a ring never wraps onto
+  // unread entries.
+  void Push(int index, int side = 0) {
+    m_queues_[side][m_tails_[side]++ & kQueueMask] = index;
+  }
+  int Pop(int side = 0) {
+    return m_queues_[side][m_heads_[side]++ & kQueueMask];
+  }
+  bool Empty(int side = 0) const { return m_heads_[side] == m_tails_[side]; }
+  int Size(int side) const { return m_tails_[side] - m_heads_[side]; }
+
+ private:
+  static constexpr int kQueueMask = 4095;
+  static_assert(kQueueMask + 1 >= kCells);
+
+  std::array<uint32_t, kCells> m_stamps_;
+  std::array<uint8_t, (kCells + 3) / 4> m_directions_;
+  std::array<std::array<uint16_t, kQueueMask + 1>, 2> m_queues_;
+  std::array<uint32_t, 2> m_heads_ = {0, 0};
+  std::array<uint32_t, 2> m_tails_ = {0, 0};
+  uint32_t m_generation_ = 0;
+};
+
+#endif  // SOLVER_WORKSPACE_H_
@@ -84,7 +84,10 @@ void QLearning::Update(const Cell &cur, int action, const Cell &next,
 void QLearning::StopLearning() { m_stop_requested_ = true; }
 #endif
 
+// Training usually runs on its own thread, whose generator starts from the
+// default seed until the thread seeds it.
 void QLearning::Train() {
+  Maze::InitRandom();
   m_is_learning_ = true;
   std::uniform_int_distribution<> dist_row(0, m_pmaze_->GetRows() - 1);
   std::uniform_int_distribution<> dist_col(0, m_pmaze_->GetCols() - 1);
@@ -6,6 +6,7 @@
 #endif
 
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <ctime>
 #include <vector>
@@ -54,7 +55,7 @@ class QLearning : public QObject {
 #endif
 
  private:
-  bool m_stop_requested_;
+  std::atomic<bool> m_stop_requested_;
   bool m_is_learning_;
   Maze *m_pmaze_;
   Cell m_goal_;
@@ -0,0 +1,41 @@
+#include "admission.h"
+
+#include <algorithm>
+#include <cmath>
+
+RateLimiter::RateLimiter(double rate, double burst)
+    : m_rate_(rate), m_burst_(std::max(burst, 1.0)) {}
+
+bool RateLimiter::Allow(const QHostAddress& address, qint64 now_ms) {
+  if (m_rate_ <= 0.0) return true;
+  auto it = m_buckets_.find(address);
+  if (it == m_buckets_.end())
+    it = m_buckets_.insert(address, {m_burst_, now_ms});
+
+  it->tokens = Refilled(*it, now_ms);
+  it->updated_ms = now_ms;
+  if (it->tokens < 1.0) return false;
+  it->tokens -= 1.0;
+  return true;
+}
+
+int RateLimiter::RetryAfter(const QHostAddress& address) const {
+  auto it = m_buckets_.constFind(address);
+  if (m_rate_ <= 0.0 || it == m_buckets_.cend()) return 0;
+  return std::max(1, static_cast<int>(std::ceil((1.0 - it->tokens) / m_rate_)));
+}
+
+// Buckets that have refilled completely carry no state and are dropped.
+void RateLimiter::Prune(qint64 now_ms) {
+  for (auto it = m_buckets_.begin(); it != m_buckets_.end();) {
+    if (Refilled(*it, now_ms) >= m_burst_)
+      it = m_buckets_.erase(it);
+    else
+      ++it;
+  }
+}
+
+double RateLimiter::Refilled(const Bucket& bucket, qint64 now_ms) const {
+  double elapsed = static_cast<double>(now_ms - bucket.updated_ms) / 1000.0;
+  return std::min(m_burst_, bucket.tokens + elapsed * m_rate_);
+}
@@ -0,0 +1,41 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <QHash>
+#include <QHostAddress>
+
+struct ServerLimits {
+  int max_connections = 256;
+  qsizetype max_header_bytes = 8 * 1024;
+  qsizetype max_body_bytes = 1024 * 1024;
+  double requests_per_second = 20.0;  // per client address, 0 disables
+  double burst = 40.0;
+  qint64 read_timeout_ms = 10 * 1000;
+  qint64 write_timeout_ms = 30 * 1000;
+};
+
+// Token bucket per client address. Every connection takes one token; tokens
+// refill at a fixed rate up to the burst size.
+class RateLimiter {
+ public:
+  RateLimiter(double rate, double burst);
+
+  bool Allow(const QHostAddress& address, qint64 now_ms);
+  int RetryAfter(const QHostAddress& address) const;
+  void Prune(qint64 now_ms);
+  int Size() const { return m_buckets_.size(); }
+
+ private:
+  struct Bucket {
+    double tokens;
+    qint64 updated_ms;
+  };
+
+  double Refilled(const Bucket& bucket, qint64 now_ms) const;
+
+  double m_rate_;
+  double m_burst_;
+  QHash<QHostAddress, Bucket> m_buckets_;
+};
+
+#endif  // ADMISSION_H
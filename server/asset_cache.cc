@@ -0,0 +1,128 @@
+#include "asset_cache.h"
+
+#include <QCryptographicHash>
+#include <QLocale>
+#include <zlib.h>
+
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+AssetCache::AssetCache(const QString& root, bool watch)
+    : m_root_(QDir(root).absolutePath()), m_pwatcher_(nullptr) {
+  if (watch) {
+    m_pwatcher_ = new QFileSystemWatcher();
+    QObject::connect(m_pwatcher_, &QFileSystemWatcher::fileChanged,
+                     m_pwatcher_,
+                     [this](const QString& path) { LoadFile(path); });
+    QObject::connect(m_pwatcher_, &QFileSystemWatcher::directoryChanged,
+                     m_pwatcher_, [this](const QString&) { Reload(); });
+  }
+  Reload();
+}
+
+AssetCache::~AssetCache() { delete m_pwatcher_; }
+
+const Asset* AssetCache::Find(const QString& path) const {
+  auto it = m_assets_.constFind(path == "/" ? QString("/index.html") : path);
+  return it == m_assets_.constEnd() ? nullptr : &it.value();
+}
+
+void AssetCache::Reload() {
+  m_assets_.clear();
+  if (m_pwatcher_) m_pwatcher_->addPath(m_root_);
+  QDirIterator it(m_root_, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    QString file_path = it.next();
+    if (it.fileInfo().isDir()) {
+      if (m_pwatcher_) m_pwatcher_->addPath(file_path);
+    } else {
+      LoadFile(file_path);
+    }
+  }
+}
+
+void AssetCache::LoadFile(const QString& file_path) {
+  QFile file(file_path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    m_assets_.remove(Key(file_path));
+    return;
+  }
+  Asset asset;
+  asset.content = file.readAll();
+  asset.content_type = ContentType(file_path);
+  asset.etag = '"' +
+               QCryptographicHash::hash(asset.content, QCryptographicHash::Sha1)
+                   .toHex()
+                   .left(16) +
+               '"';
+  asset.last_modified =
+      QLocale::c()
+          .toString(QFileInfo(file).lastModified().toUTC(),
+                    "ddd, dd MMM yyyy hh:mm:ss 'GMT'")
+          .toLatin1();
+  asset.cache_control = file_path.endsWith(".html") ? "no-cache"
+                                                    : "public, max-age=3600";
+
+  QByteArray gzip = Gzip(asset.content);
+  if (gzip.size() < asset.content.size()) asset.gzip = gzip;
+  QByteArray brotli = Brotli(asset.content);
+  if (!brotli.isEmpty() && brotli.size() < asset.content.size())
+    asset.brotli = brotli;
+
+  m_assets_.insert(Key(file_path), asset);
+  // Editors often replace files, which drops them from the watch list.
+  if (m_pwatcher_ && !m_pwatcher_->files().contains(file_path))
+    m_pwatcher_->addPath(file_path);
+}
+
+QString AssetCache::Key(const QString& file_path) const {
+  return "/" + QDir(m_root_).relativeFilePath(file_path);
+}
+
+QByteArray AssetCache::Gzip(const QByteArray& data) {
+  z_stream stream{};
+  // 16 added to the window bits selects the gzip wrapper instead of zlib.
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return {};
+
+  QByteArray out;
+  out.resize(deflateBound(&stream, data.size()));
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(out.data());
+  stream.avail_out = out.size();
+  int result = deflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return result == Z_STREAM_END ? out : QByteArray();
+}
+
+QByteArray AssetCache::Brotli(const QByteArray& data) {
+#ifdef HAVE_BROTLI
+  size_t size = BrotliEncoderMaxCompressedSize(data.size());
+  QByteArray out;
+  out.resize(size);
+  if (!BrotliEncoderCompress(
+          BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+          data.size(), reinterpret_cast<const uint8_t*>(data.constData()),
+          &size, reinterpret_cast<uint8_t*>(out.data())))
+    return {};
+  out.resize(size);
+  return out;
+#else
+  Q_UNUSED(data);
+  return {};
+#endif
+}
+
+QByteArray AssetCache::ContentType(const QString& file_path) {
+  if (file_path.endsWith(".html")) return "text/html";
+  if (file_path.endsWith(".css")) return "text/css";
+  if (file_path.endsWith(".js")) return "application/javascript";
+  if (file_path.endsWith(".svg")) return "image/svg+xml";
+  return "text/plain";
+}
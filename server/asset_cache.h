@@ -0,0 +1,49 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QString>
+
+struct Asset {
+  QByteArray content;
+  QByteArray gzip;
+  QByteArray brotli;
+  QByteArray content_type;
+  QByteArray etag;
+  QByteArray last_modified;
+  QByteArray cache_control;
+};
+
+// Static files of the web UI held in memory together with precompressed
+// variants, so GET requests never touch the disk.
+class AssetCache {
+ public:
+  explicit AssetCache(const QString& root, bool watch = false);
+  ~AssetCache();
+  AssetCache(const AssetCache&) = delete;
+  AssetCache& operator=(const AssetCache&) = delete;
+
+  const Asset* Find(const QString& path) const;
+  int Size() const { return m_assets_.size(); }
+  void Reload();
+
+ private:
+  void LoadFile(const QString& file_path);
+  QString Key(const QString& file_path) const;
+  static QByteArray Gzip(const QByteArray& data);
+  static QByteArray Brotli(const QByteArray& data);
+  static QByteArray ContentType(const QString& file_path);
+
+  QString m_root_;
+  QHash<QString, Asset> m_assets_;
+  QFileSystemWatcher* m_pwatcher_;
+};
+
+#endif  // ASSET_CACHE_H
@@ -0,0 +1,102 @@
+#include "binary_protocol.h"
+
+namespace {
+constexpr qsizetype kSizeBytes = 2 * sizeof(quint16);
+constexpr qsizetype kPathHeaderBytes = 6 * sizeof(quint16);
+constexpr qsizetype kBatchHeaderBytes = 2 * sizeof(quint16) + sizeof(quint32);
+constexpr qsizetype kQueryBytes = 4 * sizeof(quint16);
+}  // namespace
+
+bool BinaryProtocol::ReadSize(const QByteArray& data, int& rows, int& cols) {
+  if (data.size() != kSizeBytes) return false;
+  rows = Read<quint16>(data, 0);
+  cols = Read<quint16>(data, sizeof(quint16));
+  return true;
+}
+
+bool BinaryProtocol::ReadPathRequest(
+    const QByteArray& data, int& rows, int& cols, Cell& start, Cell& end,
+    std::array<uint64_t, kMaxSize>& verticals,
+    std::array<uint64_t, kMaxSize>& horizontals) {
+  if (data.size() < kPathHeaderBytes) return false;
+  rows = Read<quint16>(data, 0);
+  cols = Read<quint16>(data, 2);
+  start = {Read<quint16>(data, 4), Read<quint16>(data, 6)};
+  end = {Read<quint16>(data, 8), Read<quint16>(data, 10)};
+  if (rows <= 0 || rows > kMaxSize) return false;
+
+  qsizetype words = static_cast<qsizetype>(rows) * sizeof(quint64);
+  if (data.size() != kPathHeaderBytes + 2 * words) return false;
+
+  verticals.fill(0);
+  horizontals.fill(0);
+  for (int i = 0; i < rows; ++i) {
+    verticals[i] = Read<quint64>(data, kPathHeaderBytes + i * 8);
+    horizontals[i] = Read<quint64>(data, kPathHeaderBytes + words + i * 8);
+  }
+  return true;
+}
+
+// Queries keep the (start, end) order /pass passes to Maze::SolveMaze.
+bool BinaryProtocol::ReadBatchRequest(
+    const QByteArray& data, int& rows, int& cols,
+    std::array<uint64_t, kMaxSize>& verticals,
+    std::array<uint64_t, kMaxSize>& horizontals,
+    std::vector<std::pair<Cell, Cell>>& queries) {
+  if (data.size() < kBatchHeaderBytes) return false;
+  rows = Read<quint16>(data, 0);
+  cols = Read<quint16>(data, 2);
+  quint32 count = Read<quint32>(data, 4);
+  if (rows <= 0 || rows > kMaxSize) return false;
+
+  qsizetype words = static_cast<qsizetype>(rows) * sizeof(quint64);
+  qsizetype offset = kBatchHeaderBytes + 2 * words;
+  if (data.size() != offset + static_cast<qsizetype>(count) * kQueryBytes)
+    return false;
+
+  verticals.fill(0);
+  horizontals.fill(0);
+  for (int i = 0; i < rows; ++i) {
+    verticals[i] = Read<quint64>(data, kBatchHeaderBytes + i * 8);
+    horizontals[i] = Read<quint64>(data, kBatchHeaderBytes + words + i * 8);
+  }
+  queries.clear();
+  queries.reserve(count);
+  for (; offset < data.size(); offset += kQueryBytes) {
+    Cell start{Read<quint16>(data, offset), Read<quint16>(data, offset + 2)};
+    Cell end{Read<quint16>(data, offset + 4), Read<quint16>(data, offset + 6)};
+    queries.push_back({start, end});
+  }
+  return true;
+}
+
+QByteArray BinaryProtocol::WriteMaze(const Maze& maze, quint64 id) {
+  int rows = maze.GetRows();
+  auto verticals = maze.GetVerticals();
+  auto horizontals = maze.GetHorizontals();
+
+  QByteArray out;
+  out.reserve(kSizeBytes + (2 * rows + 1) * sizeof(quint64));
+  Append<quint16>(out, rows);
+  Append<quint16>(out, maze.GetCols());
+  for (int i = 0; i < rows; ++i) Append<quint64>(out, verticals[i]);
+  for (int i = 0; i < rows; ++i) Append<quint64>(out, horizontals[i]);
+  Append<quint64>(out, id);
+  return out;
+}
+
+QByteArray BinaryProtocol::WritePath(const std::vector<Cell>& pass) {
+  QByteArray out;
+  out.reserve(sizeof(quint32) + pass.size() * 2 * sizeof(quint16));
+  AppendPath(out, pass);
+  return out;
+}
+
+void BinaryProtocol::AppendPath(QByteArray& out,
+                                const std::vector<Cell>& pass) {
+  Append<quint32>(out, pass.size());
+  for (const auto& p : pass) {
+    Append<quint16>(out, p.r);
+    Append<quint16>(out, p.c);
+  }
+}
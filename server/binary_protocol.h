@@ -0,0 +1,61 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <QByteArray>
+#include <QtEndian>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "../model/maze/maze.h"
+
+// Little-endian wire format used instead of JSON when the client sends or
+// accepts application/octet-stream.
+//
+//   /generate request:  u16 rows, u16 cols
+//   /generate response: u16 rows, u16 cols, u64 verticals[rows],
+//                       u64 horizontals[rows], u64 id
+//   /pass request:      u16 rows, u16 cols, u16 start_r, u16 start_c,
+//                       u16 end_r, u16 end_c, u64 verticals[rows],
+//                       u64 horizontals[rows]
+//   /pass response:     u32 count, {u16 r, u16 c}[count]
+//   /pass/batch request:  u16 rows, u16 cols, u32 count,
+//                         u64 verticals[rows], u64 horizontals[rows],
+//                         {u16 start_r, u16 start_c, u16 end_r,
+//                          u16 end_c}[count]
+//   /pass/batch response: u32 count, then a /pass response per query
+class BinaryProtocol {
+ public:
+  static constexpr const char* kContentType = "application/octet-stream";
+
+  static bool ReadSize(const QByteArray& data, int& rows, int& cols);
+  static bool ReadPathRequest(const QByteArray& data, int& rows, int& cols,
+                              Cell& start, Cell& end,
+                              std::array<uint64_t, kMaxSize>& verticals,
+                              std::array<uint64_t, kMaxSize>& horizontals);
+  static bool ReadBatchRequest(const QByteArray& data, int& rows, int& cols,
+                               std::array<uint64_t, kMaxSize>& verticals,
+                               std::array<uint64_t, kMaxSize>& horizontals,
+                               std::vector<std::pair<Cell, Cell>>& queries);
+  static QByteArray WriteMaze(const Maze& maze, quint64 id);
+  static QByteArray WritePath(const std::vector<Cell>& pass);
+  static void AppendPath(QByteArray& out, const std::vector<Cell>& pass);
+  static void AppendCount(QByteArray& out, quint32 count) {
+    Append<quint32>(out, count);
+  }
+
+ private:
+  template <typename T>
+  static void Append(QByteArray& out, T value) {
+    uchar buf[sizeof(T)];
+    qToLittleEndian<T>(value, buf);
+    out.append(reinterpret_cast<const char*>(buf), sizeof(T));
+  }
+
+  template <typename T>
+  static T Read(const QByteArray& data, qsizetype offset) {
+    return qFromLittleEndian<T>(data.constData() + offset);
+  }
+};
+
+#endif  // BINARY_PROTOCOL_H
@@ -0,0 +1,124 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+// Append-only compact JSON serializer. Writes straight into the caller's
+// buffer (std::string or QByteArray), so a response costs one allocation
+// when the buffer is reserved up front.
+template <typename Buffer>
+class JsonWriter {
+ public:
+  explicit JsonWriter(Buffer& out) : m_out_(out), m_depth_(0), m_key_(false) {
+    m_first_[0] = true;
+  }
+
+  void BeginObject() { Open('{'); }
+  void EndObject() { Close('}'); }
+  void BeginArray() { Open('['); }
+  void EndArray() { Close(']'); }
+
+  void Key(std::string_view key) {
+    Separate();
+    WriteString(key);
+    Put(':');
+    m_key_ = true;
+  }
+
+  void Int(int64_t value) {
+    Separate();
+    WriteNumber(value);
+  }
+
+  void UInt(uint64_t value) {
+    Separate();
+    WriteNumber(value);
+  }
+
+  // Unsigned number wrapped in quotes, for 64-bit values that JavaScript
+  // cannot hold as a Number.
+  void UIntString(uint64_t value) {
+    Separate();
+    Put('"');
+    WriteNumber(value);
+    Put('"');
+  }
+
+  void String(std::string_view value) {
+    Separate();
+    WriteString(value);
+  }
+
+  void Bool(bool value) {
+    Separate();
+    value ? Append("true") : Append("false");
+  }
+
+ private:
+  static constexpr int kMaxDepth = 16;
+
+  void Open(char c) {
+    Separate();
+    Put(c);
+    if (m_depth_ + 1 < kMaxDepth) ++m_depth_;
+    m_first_[m_depth_] = true;
+  }
+
+  void Close(char c) {
+    if (m_depth_ > 0) --m_depth_;
+    Put(c);
+  }
+
+  void Separate() {
+    if (m_key_) {
+      m_key_ = false;
+    } else {
+      if (!m_first_[m_depth_]) Put(',');
+      m_first_[m_depth_] = false;
+    }
+  }
+
+  template <typename T>
+  void WriteNumber(T value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    m_out_.append(buf, res.ptr - buf);
+  }
+
+  void WriteString(std::string_view value) {
+    Put('"');
+    std::size_t plain = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      unsigned char ch = value[i];
+      if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+      if (i > plain) m_out_.append(value.data() + plain, i - plain);
+      plain = i + 1;
+      if (ch == '"' || ch == '\\') {
+        char esc[2] = {'\\', static_cast<char>(ch)};
+        m_out_.append(esc, 2);
+      } else {
+        static constexpr char kHex[] = "0123456789abcdef";
+        char esc[6] = {'\\', 'u', '0', '0', kHex[ch >> 4], kHex[ch & 0xf]};
+        m_out_.append(esc, 6);
+      }
+    }
+    if (value.size() > plain)
+      m_out_.append(value.data() + plain, value.size() - plain);
+    Put('"');
+  }
+
+  void Append(std::string_view text) {
+    m_out_.append(text.data(), text.size());
+  }
+  void Put(char c) { m_out_.append(&c, 1); }
+
+  Buffer& m_out_;
+  int m_depth_;
+  bool m_key_;
+  std::array<bool, kMaxDepth> m_first_;
+};
+
+#endif  // JSON_WRITER_H
@@ -5,7 +5,7 @@
 int main(int argc, char *argv[]) {
   QApplication app(argc, argv);
 
-  TcpServer server(8080);
+  TcpServer server(8080, nullptr, app.arguments().contains("--watch"));
   server.show();
   return app.exec();
 }
@@ -0,0 +1,104 @@
+#include "metrics.h"
+
+#include <bit>
+
+void LatencyHistogram::Record(int64_t ns) {
+  if (ns < 0) ns = 0;
+  // Rounded up, so a sample never lands in a bucket below its latency.
+  uint64_t us = (static_cast<uint64_t>(ns) + 999) / 1000;
+  int bucket = us <= 1 ? 0 : std::bit_width(us - 1);
+  if (bucket > kBuckets) bucket = kBuckets;
+  m_buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  m_count_.fetch_add(1, std::memory_order_relaxed);
+  m_sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Render(QByteArray& out, const QByteArray& name,
+                              const QByteArray& labels) const {
+  uint64_t cumulative = 0;
+  for (int i = 0; i <= kBuckets; ++i) {
+    cumulative += m_buckets_[i].load(std::memory_order_relaxed);
+    out.append(name + "_bucket{" + labels + ",le=\"");
+    if (i == kBuckets)
+      out.append("+Inf");
+    else
+      out.append(QByteArray::number((uint64_t{1} << i) * 1e-6, 'g', 7));
+    out.append("\"} " + QByteArray::number(cumulative) + '\n');
+  }
+  double sum = m_sum_ns_.load(std::memory_order_relaxed) * 1e-9;
+  out.append(name + "_sum{" + labels + "} " + QByteArray::number(sum, 'g', 9) +
+             '\n');
+  out.append(name + "_count{" + labels + "} " +
+             QByteArray::number(m_count_.load(std::memory_order_relaxed)) +
+             '\n');
+}
+
+QByteArray ServerMetrics::Render() const {
+  QByteArray out;
+  out.reserve(64 * 1024);
+
+  out.append(
+      "# HELP maze_requests_total Requests received per route.\n"
+      "# TYPE maze_requests_total counter\n");
+  for (int r = 0; r < kRoutes; ++r) {
+    out.append(QByteArray("maze_requests_total{route=\"") + RouteName(r) +
+               "\"} " +
+               QByteArray::number(m_requests_[r].load(
+                   std::memory_order_relaxed)) +
+               '\n');
+  }
+
+  out.append(
+      "# HELP maze_request_phase_seconds Time spent per route and phase.\n"
+      "# TYPE maze_request_phase_seconds histogram\n");
+  for (int r = 0; r < kRoutes; ++r) {
+    for (int p = 0; p < kPhases; ++p) {
+      QByteArray labels = QByteArray("route=\"") + RouteName(r) +
+                          "\",phase=\"" + PhaseName(p) + '"';
+      m_latency_[r][p].Render(out, "maze_request_phase_seconds", labels);
+    }
+  }
+
+  out.append(
+      "# HELP maze_connections Currently open client connections.\n"
+      "# TYPE maze_connections gauge\n"
+      "maze_connections " +
+      QByteArray::number(m_connections_.load(std::memory_order_relaxed)) +
+      "\n# HELP maze_connections_total Accepted client connections.\n"
+      "# TYPE maze_connections_total counter\n"
+      "maze_connections_total " +
+      QByteArray::number(m_connections_total_.load(std::memory_order_relaxed)) +
+      "\n# HELP maze_received_bytes_total Bytes read from clients.\n"
+      "# TYPE maze_received_bytes_total counter\n"
+      "maze_received_bytes_total " +
+      QByteArray::number(m_bytes_in_.load(std::memory_order_relaxed)) +
+      "\n# HELP maze_sent_bytes_total Bytes written to clients.\n"
+      "# TYPE maze_sent_bytes_total counter\n"
+      "maze_sent_bytes_total " +
+      QByteArray::number(m_bytes_out_.load(std::memory_order_relaxed)) + '\n');
+
+  out.append(
+      "# HELP maze_rejected_total Requests refused by admission control.\n"
+      "# TYPE maze_rejected_total counter\n");
+  for (size_t i = 0; i < kRejectCodes.size(); ++i) {
+    out.append("maze_rejected_total{code=\"" +
+               QByteArray::number(kRejectCodes[i]) + "\"} " +
+               QByteArray::number(m_rejected_[i].load(
+                   std::memory_order_relaxed)) +
+               '\n');
+  }
+  return out;
+}
+
+const char* ServerMetrics::RouteName(int route) {
+  static constexpr const char* kNames[kRoutes] = {
+      "/generate", "/pass",   "/pass/batch", "/train", "/cave",
+      "static",    "options", "/metrics",    "other"};
+  return kNames[route];
+}
+
+const char* ServerMetrics::PhaseName(int phase) {
+  static constexpr const char* kNames[kPhases] = {"parse", "compute", "write",
+                                                  "total"};
+  return kNames[phase];
+}
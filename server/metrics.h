@@ -0,0 +1,96 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+enum class Route {
+  kGenerate,
+  kPass,
+  kBatch,
+  kTrain,
+  kCave,
+  kStatic,
+  kOptions,
+  kMetrics,
+  kOther
+};
+enum class Phase { kParse, kCompute, kWrite, kTotal };
+
+constexpr int kRoutes = 9;
+constexpr int kPhases = 4;
+constexpr std::array<int, 7> kRejectCodes = {400, 408, 411, 413,
+                                              429, 431, 503};
+
+// Log-bucketed latency histogram: bucket i counts samples up to 2^i
+// microseconds, the last bucket everything slower.
+class LatencyHistogram {
+ public:
+  static constexpr int kBuckets = 24;
+
+  void Record(int64_t ns);
+  void Render(QByteArray& out, const QByteArray& name,
+              const QByteArray& labels) const;
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets + 1> m_buckets_{};
+  std::atomic<uint64_t> m_count_{0};
+  std::atomic<uint64_t> m_sum_ns_{0};
+};
+
+// Lock-free server counters exposed on GET /metrics in the Prometheus text
+// format.
+class ServerMetrics {
+ public:
+  void Record(Route route, Phase phase, int64_t ns) {
+    m_latency_[static_cast<int>(route)][static_cast<int>(phase)].Record(ns);
+  }
+  void CountRequest(Route route) {
+    m_requests_[static_cast<int>(route)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+  }
+  void AddBytesIn(int64_t n) {
+    m_bytes_in_.fetch_add(n, std::memory_order_relaxed);
+  }
+  void AddBytesOut(int64_t n) {
+    m_bytes_out_.fetch_add(n, std::memory_order_relaxed);
+  }
+  void ConnectionOpened() {
+    m_connections_.fetch_add(1, std::memory_order_relaxed);
+    m_connections_total_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void ConnectionClosed() {
+    m_connections_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  void CountRejected(int status) {
+    for (size_t i = 0; i < kRejectCodes.size(); ++i) {
+      if (kRejectCodes[i] == status)
+        m_rejected_[i].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  QByteArray Render() const;
+
+  static int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+ private:
+  static const char* RouteName(int route);
+  static const char* PhaseName(int phase);
+
+  std::array<std::array<LatencyHistogram, kPhases>, kRoutes> m_latency_;
+  std::array<std::atomic<uint64_t>, kRoutes> m_requests_{};
+  std::atomic<uint64_t> m_bytes_in_{0};
+  std::atomic<uint64_t> m_bytes_out_{0};
+  std::atomic<int64_t> m_connections_{0};
+  std::atomic<uint64_t> m_connections_total_{0};
+  std::array<std::atomic<uint64_t>, kRejectCodes.size()> m_rejected_{};
+};
+
+#endif  // METRICS_H
@@ -0,0 +1,68 @@
+#include "response_cache.h"
+
+namespace {
+// Approximate bookkeeping per entry: hash node, list node, array headers.
+constexpr qsizetype kEntryOverhead = 96;
+}  // namespace
+
+ResponseCache::ResponseCache(qsizetype budget_bytes)
+    : m_budget_(budget_bytes), m_bytes_(0), m_hits_(0), m_misses_(0) {}
+
+QByteArray ResponseCache::Key(int rows, int cols,
+                              const std::array<uint64_t, kMaxSize>& verticals,
+                              const std::array<uint64_t, kMaxSize>& horizontals,
+                              const Cell& start, const Cell& end,
+                              char format) {
+  QByteArray key;
+  key.resize(8 + 2 * rows * sizeof(quint64));
+  char* out = key.data();
+  out[0] = format;
+  out[1] = static_cast<char>(rows);
+  out[2] = static_cast<char>(cols);
+  out[3] = static_cast<char>(start.r);
+  out[4] = static_cast<char>(start.c);
+  out[5] = static_cast<char>(end.r);
+  out[6] = static_cast<char>(end.c);
+  out[7] = 0;
+  out += 8;
+  for (int i = 0; i < rows; ++i, out += 16) {
+    qToLittleEndian<quint64>(verticals[i], out);
+    qToLittleEndian<quint64>(horizontals[i], out + 8);
+  }
+  return key;
+}
+
+const QByteArray* ResponseCache::Find(const QByteArray& key) {
+  auto it = m_entries_.find(key);
+  if (it == m_entries_.end()) {
+    ++m_misses_;
+    return nullptr;
+  }
+  ++m_hits_;
+  m_lru_.splice(m_lru_.begin(), m_lru_, it->lru);
+  return &it->body;
+}
+
+void ResponseCache::Insert(const QByteArray& key, const QByteArray& body) {
+  qsizetype cost = Cost(key, body);
+  if (cost > m_budget_ || m_entries_.contains(key)) return;
+  while (!m_lru_.empty() && m_bytes_ + cost > m_budget_) EvictOldest();
+
+  m_lru_.push_front(key);
+  m_entries_.insert(key, {body, m_lru_.begin()});
+  m_bytes_ += cost;
+}
+
+qsizetype ResponseCache::Cost(const QByteArray& key, const QByteArray& body) {
+  // The LRU list shares the key data with the hash.
+  return key.size() + body.size() + kEntryOverhead;
+}
+
+void ResponseCache::EvictOldest() {
+  auto it = m_entries_.find(m_lru_.back());
+  if (it != m_entries_.end()) {
+    m_bytes_ -= Cost(it.key(), it->body);
+    m_entries_.erase(it);
+  }
+  m_lru_.pop_back();
+}
@@ -0,0 +1,50 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QtEndian>
+#include <array>
+#include <list>
+
+#include "../model/maze/maze.h"
+
+// Serialized /pass responses addressed by the request content: dimensions,
+// packed wall words, endpoints and response encoding. Identical mazes sent by
+// different clients share one entry. Least recently used entries are evicted
+// once the memory budget is exceeded.
+class ResponseCache {
+ public:
+  explicit ResponseCache(qsizetype budget_bytes = 16 * 1024 * 1024);
+
+  static QByteArray Key(int rows, int cols,
+                        const std::array<uint64_t, kMaxSize>& verticals,
+                        const std::array<uint64_t, kMaxSize>& horizontals,
+                        const Cell& start, const Cell& end, char format);
+
+  const QByteArray* Find(const QByteArray& key);
+  void Insert(const QByteArray& key, const QByteArray& body);
+
+  quint64 Hits() const { return m_hits_; }
+  quint64 Misses() const { return m_misses_; }
+  qsizetype Bytes() const { return m_bytes_; }
+  qsizetype Size() const { return m_entries_.size(); }
+
+ private:
+  struct Entry {
+    QByteArray body;
+    std::list<QByteArray>::iterator lru;
+  };
+
+  static qsizetype Cost(const QByteArray& key, const QByteArray& body);
+  void EvictOldest();
+
+  qsizetype m_budget_;
+  qsizetype m_bytes_;
+  quint64 m_hits_;
+  quint64 m_misses_;
+  QHash<QByteArray, Entry> m_entries_;
+  std::list<QByteArray> m_lru_;  // most recently used first
+};
+
+#endif  // RESPONSE_CACHE_H
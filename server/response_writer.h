@@ -0,0 +1,126 @@
+#ifndef RESPONSE_WRITER_H
+#define RESPONSE_WRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "../model/maze/maze.h"
+#include "json_writer.h"
+
+// JSON bodies and HTTP headers of the server's responses. Templated on the
+// buffer so that TcpServer writes into QByteArray and the response bench
+// into std::string through the same code. Each writer reserves what it
+// needs up front and numbers go through to_chars, so a body or a header
+// costs one allocation.
+class ResponseWriter {
+ public:
+  template <typename Buffer>
+  static void WriteMaze(Buffer& out, const Maze& maze, uint64_t id) {
+    const int rows = maze.GetRows();
+    auto verticals = maze.GetVerticals();
+    auto horizontals = maze.GetHorizontals();
+    out.reserve(out.size() + 96 + 2 * rows * 23);
+    char hex[16];
+    auto res = std::to_chars(hex, hex + sizeof(hex), id, 16);
+    JsonWriter<Buffer> json(out);
+    json.BeginObject();
+    json.Key("id");
+    json.String(std::string_view(hex, res.ptr - hex));
+    json.Key("verticals");
+    json.BeginArray();
+    for (int i = 0; i < rows; ++i) json.UIntString(verticals[i]);
+    json.EndArray();
+    json.Key("horizontals");
+    json.BeginArray();
+    for (int i = 0; i < rows; ++i) json.UIntString(horizontals[i]);
+    json.EndArray();
+    json.EndObject();
+  }
+
+  // {"pass": [[r, c], ...]}
+  template <typename Buffer>
+  static void WritePass(Buffer& out, const std::vector<Cell>& pass) {
+    out.reserve(out.size() + 16 + pass.size() * 8);
+    JsonWriter<Buffer> json(out);
+    json.BeginObject();
+    json.Key("pass");
+    WritePath(json, pass);
+    json.EndObject();
+  }
+
+  // [[r, c], ...] as the next value of an open writer.
+  template <typename Buffer>
+  static void WritePath(JsonWriter<Buffer>& json,
+                        const std::vector<Cell>& pass) {
+    json.BeginArray();
+    for (const auto& p : pass) {
+      json.BeginArray();
+      json.Int(p.r);
+      json.Int(p.c);
+      json.EndArray();
+    }
+    json.EndArray();
+  }
+
+  template <typename Buffer>
+  static void WriteCave(Buffer& out, const Maze& cave, const CaveRun& run) {
+    auto cells = cave.GetVerticals();
+    out.reserve(out.size() + 64 + cave.GetRows() * 23);
+    JsonWriter<Buffer> json(out);
+    json.BeginObject();
+    json.Key("cells");
+    json.BeginArray();
+    for (int i = 0; i < cave.GetRows(); ++i) json.UIntString(cells[i]);
+    json.EndArray();
+    json.Key("steps");
+    json.Int(run.steps);
+    json.Key("stable");
+    json.Bool(run.period == 1);
+    json.Key("period");
+    json.Int(run.period);
+    json.EndObject();
+  }
+
+  // Status line and headers of a Content-Length response, up to and
+  // including the blank line. extra_headers are complete "Name: value\r\n"
+  // lines.
+  template <typename Buffer>
+  static void WriteHeader(Buffer& out, int status, std::string_view status_text,
+                          std::string_view content_type,
+                          std::size_t content_length,
+                          std::string_view extra_headers = {}) {
+    out.reserve(out.size() + 128 + status_text.size() + content_type.size() +
+                extra_headers.size());
+    Append(out, "HTTP/1.1 ");
+    AppendNumber(out, status);
+    Append(out, " ");
+    Append(out, status_text);
+    Append(out, "\r\nContent-Type: ");
+    Append(out, content_type);
+    Append(out, "\r\nContent-Length: ");
+    AppendNumber(out, content_length);
+    Append(out, "\r\n");
+    Append(out, extra_headers);
+    Append(out,
+           "Access-Control-Allow-Origin: *\r\n"
+           "Connection: close\r\n\r\n");
+  }
+
+ private:
+  template <typename Buffer>
+  static void Append(Buffer& out, std::string_view text) {
+    out.append(text.data(), text.size());
+  }
+
+  template <typename Buffer, typename T>
+  static void AppendNumber(Buffer& out, T value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr - buf);
+  }
+};
+
+#endif  // RESPONSE_WRITER_H
@@ -0,0 +1,109 @@
+#include "session_store.h"
+
+namespace {
+// Hash node, vector header and key of a cached path, on top of its cells.
+constexpr qsizetype kPathOverhead = 64;
+}  // namespace
+
+SessionStore::SessionStore(int max_sessions, qint64 ttl_ms, int max_paths,
+                           qsizetype max_path_bytes)
+    : m_max_sessions_(max_sessions),
+      m_ttl_ms_(ttl_ms),
+      m_max_paths_(max_paths),
+      m_max_path_bytes_(max_path_bytes),
+      m_path_bytes_(0) {
+  m_clock_.start();
+}
+
+quint64 SessionStore::Insert(const Maze& maze) {
+  DropExpired();
+  while (!m_lru_.empty() && m_sessions_.size() >= m_max_sessions_)
+    Remove(m_lru_.back());
+
+  quint64 id = QRandomGenerator::global()->generate64();
+  while (id == 0 || m_sessions_.contains(id))
+    id = QRandomGenerator::global()->generate64();
+
+  MazeSession session;
+  session.maze = maze;
+  session.last_access = m_clock_.elapsed();
+  m_lru_.push_front(id);
+  m_sessions_.insert(id, {std::move(session), m_lru_.begin()});
+  return id;
+}
+
+MazeSession* SessionStore::Find(quint64 id) {
+  auto it = m_sessions_.find(id);
+  if (it == m_sessions_.end()) return nullptr;
+
+  qint64 now = m_clock_.elapsed();
+  if (now - it->session.last_access > m_ttl_ms_) {
+    Remove(id);
+    return nullptr;
+  }
+  it->session.last_access = now;
+  m_lru_.splice(m_lru_.begin(), m_lru_, it->lru);
+  return &it->session;
+}
+
+quint32 SessionStore::PathKey(const Cell& start, const Cell& end) {
+  return ((start.r * kMaxSize + start.c) * kMaxSize + end.r) * kMaxSize +
+         end.c;
+}
+
+const std::vector<Cell>* SessionStore::FindPath(MazeSession& session,
+                                                quint32 key) const {
+  auto it = session.paths.constFind(key);
+  return it == session.paths.constEnd() ? nullptr : &it.value();
+}
+
+// Room is made one path at a time: first within the session if it holds
+// max_paths, then across sessions from the least recently used one until
+// the new path fits the byte budget.
+void SessionStore::StorePath(MazeSession& session, quint32 key,
+                             const std::vector<Cell>& pass) {
+  qsizetype cost = PathCost(pass);
+  if (cost > m_max_path_bytes_ || session.paths.contains(key)) return;
+  if (session.paths.size() >= m_max_paths_) DropOldestPath(session);
+  for (auto id = m_lru_.rbegin();
+       id != m_lru_.rend() && m_path_bytes_ + cost > m_max_path_bytes_; ++id) {
+    MazeSession& victim = m_sessions_.find(*id)->session;
+    while (!victim.path_order.empty() &&
+           m_path_bytes_ + cost > m_max_path_bytes_)
+      DropOldestPath(victim);
+  }
+  session.paths.insert(key, pass);
+  session.path_order.push_back(key);
+  session.path_bytes += cost;
+  m_path_bytes_ += cost;
+}
+
+void SessionStore::DropOldestPath(MazeSession& session) {
+  if (session.path_order.empty()) return;
+  auto it = session.paths.find(session.path_order.front());
+  session.path_order.pop_front();
+  qsizetype cost = PathCost(*it);
+  session.path_bytes -= cost;
+  m_path_bytes_ -= cost;
+  session.paths.erase(it);
+}
+
+qsizetype SessionStore::PathCost(const std::vector<Cell>& pass) {
+  return kPathOverhead + static_cast<qsizetype>(pass.size() * sizeof(Cell));
+}
+
+void SessionStore::DropExpired() {
+  qint64 now = m_clock_.elapsed();
+  while (!m_lru_.empty() &&
+         now - m_sessions_.constFind(m_lru_.back())->session.last_access >
+             m_ttl_ms_)
+    Remove(m_lru_.back());
+}
+
+void SessionStore::Remove(quint64 id) {
+  auto it = m_sessions_.find(id);
+  if (it == m_sessions_.end()) return;
+  m_path_bytes_ -= it->session.path_bytes;
+  m_lru_.erase(it->lru);
+  m_sessions_.erase(it);
+}
@@ -0,0 +1,62 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRandomGenerator>
+#include <deque>
+#include <list>
+#include <vector>
+
+#include "../model/maze/maze.h"
+
+struct MazeSession {
+  Maze maze;
+  QHash<quint32, std::vector<Cell>> paths;  // solved paths by endpoints
+  std::deque<quint32> path_order;           // keys of paths, oldest first
+  qsizetype path_bytes = 0;                 // charged for cached paths
+  qint64 last_access = 0;
+};
+
+// Mazes handed out by /generate, so /pass can refer to them by id instead of
+// resending the walls. Bounded by count (least recently used is evicted
+// first) and by idle time. Cached paths share one byte budget; when it runs
+// out, the oldest paths of the least recently used sessions go first.
+class SessionStore {
+ public:
+  explicit SessionStore(int max_sessions = 4096,
+                        qint64 ttl_ms = 30 * 60 * 1000, int max_paths = 256,
+                        qsizetype max_path_bytes = 32 * 1024 * 1024);
+
+  quint64 Insert(const Maze& maze);
+  MazeSession* Find(quint64 id);
+  int Size() const { return m_sessions_.size(); }
+  qsizetype PathBytes() const { return m_path_bytes_; }
+
+  static quint32 PathKey(const Cell& start, const Cell& end);
+  const std::vector<Cell>* FindPath(MazeSession& session, quint32 key) const;
+  void StorePath(MazeSession& session, quint32 key,
+                 const std::vector<Cell>& pass);
+
+ private:
+  struct Entry {
+    MazeSession session;
+    std::list<quint64>::iterator lru;
+  };
+
+  void DropExpired();
+  void Remove(quint64 id);
+  void DropOldestPath(MazeSession& session);
+  static qsizetype PathCost(const std::vector<Cell>& pass);
+
+  int m_max_sessions_;
+  qint64 m_ttl_ms_;
+  int m_max_paths_;
+  qsizetype m_max_path_bytes_;
+  qsizetype m_path_bytes_;
+  QElapsedTimer m_clock_;
+  QHash<quint64, Entry> m_sessions_;
+  std::list<quint64> m_lru_;  // most recently used first
+};
+
+#endif  // SESSION_STORE_H
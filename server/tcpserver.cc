@@ -1,9 +1,35 @@
 #include "tcpserver.h"
 
-TcpServer::TcpServer(quint16 port, QWidget* parent) : QWidget(parent) {
+#include <algorithm>
+#include <thread>
+
+#include "json_writer.h"
+#include "response_writer.h"
+
+namespace {
+constexpr qsizetype kMaxBatchQueries = 10000;
+constexpr qsizetype kBatchChunkBytes = 16 * 1024;
+constexpr size_t kBatchQueriesPerThread = 256;
+constexpr int kMaxTrainings = 2;
+constexpr int kMaxCaveSteps = 1000;
+constexpr int kMaxCaveRadius = 3;
+}  // namespace
+
+TcpServer::TcpServer(quint16 port, QWidget* parent, bool watch_assets,
+                     const ServerLimits& limits)
+    : QWidget(parent),
+      m_limits_(limits),
+      m_rate_limiter_(limits.requests_per_second, limits.burst),
+      m_assets_("server/web", watch_assets),
+      m_route_(Route::kOther),
+      m_request_start_(0),
+      m_parsing_(false),
+      m_trainings_(0) {
   m_ptcp_server_ = new QTcpServer(this);
   m_ptxt_ = new QTextEdit(this);
   m_ptxt_->setReadOnly(true);
+  m_clock_.start();
+  m_pass_.reserve(kMaxSize * kMaxSize);
 
   QVBoxLayout* layout = new QVBoxLayout(this);
   layout->addWidget(m_ptxt_);
@@ -12,18 +38,24 @@ TcpServer::TcpServer(quint16 port, QWidget* parent) : QWidget(parent) {
   connect(m_ptcp_server_, &QTcpServer::newConnection, this,
           &TcpServer::OnNewConnection);
 
+  m_psweep_timer_ = new QTimer(this);
+  connect(m_psweep_timer_, &QTimer::timeout, this, &TcpServer::OnSweep);
+  m_psweep_timer_->start(1000);
+
   if (!m_ptcp_server_->listen(QHostAddress::Any, port)) {
     m_ptxt_->append("Unable to start the server: " +
                     m_ptcp_server_->errorString());
     return;
   }
   m_ptxt_->append("Server started on port " + QString::number(port));
+  m_ptxt_->append("Cached " + QString::number(m_assets_.Size()) +
+                  " static files");
   setWindowTitle("TCP Server - Port " + QString::number(port));
   resize(500, 700);
 }
 
 TcpServer::~TcpServer() {
-  for (QTcpSocket* client : m_clients_) {
+  for (QTcpSocket* client : m_clients_.keys()) {
     client->close();
     client->deleteLater();
   }
@@ -34,83 +66,341 @@ TcpServer::~TcpServer() {
 void TcpServer::OnNewConnection() {
   while (m_ptcp_server_->hasPendingConnections()) {
     QTcpSocket* client_socket = m_ptcp_server_->nextPendingConnection();
-    m_clients_.append(client_socket);
+    ClientState state;
+    state.last_activity = m_clock_.elapsed();
+    m_clients_.insert(client_socket, state);
+    m_metrics_.ConnectionOpened();
 
     connect(client_socket, &QTcpSocket::readyRead, this,
             [this, client_socket]() { OnReadyRead(client_socket); });
     connect(client_socket, &QTcpSocket::disconnected, this,
             [this, client_socket]() { OnClientDisconnected(client_socket); });
+    connect(client_socket, &QTcpSocket::bytesWritten, this,
+            [this, client_socket]() {
+              auto it = m_clients_.find(client_socket);
+              if (it != m_clients_.end())
+                it->last_activity = m_clock_.elapsed();
+            });
 
+    if (!AdmitConnection(client_socket)) continue;
     m_ptxt_->append("New client connected from " +
                     client_socket->peerAddress().toString());
   }
 }
 
+// Connection count and rate are checked once per connection, before anything
+// is read; every request arrives on its own connection.
+bool TcpServer::AdmitConnection(QTcpSocket* client) {
+  if (m_clients_.size() > m_limits_.max_connections) {
+    Reject(client, 503, "Service Unavailable", "Retry-After: 1\r\n");
+    return false;
+  }
+  QHostAddress address = client->peerAddress();
+  if (!m_rate_limiter_.Allow(address, m_clock_.elapsed())) {
+    Reject(client, 429, "Too Many Requests",
+           "Retry-After: " +
+               QByteArray::number(m_rate_limiter_.RetryAfter(address)) +
+               "\r\n");
+    return false;
+  }
+  return true;
+}
+
 void TcpServer::OnClientDisconnected(QTcpSocket* client_socket) {
   if (!client_socket) return;
 
   m_ptxt_->append("Client disconnected: " +
                   client_socket->peerAddress().toString());
-  m_clients_.removeAll(client_socket);
+  if (m_clients_.remove(client_socket)) m_metrics_.ConnectionClosed();
   client_socket->deleteLater();
 }
 
+void TcpServer::OnSweep() {
+  qint64 now = m_clock_.elapsed();
+  QList<QTcpSocket*> slow_readers;
+  QList<QTcpSocket*> slow_writers;
+  for (auto it = m_clients_.cbegin(); it != m_clients_.cend(); ++it) {
+    qint64 idle = now - it->last_activity;
+    if (!it->responded && idle > m_limits_.read_timeout_ms) {
+      slow_readers.append(it.key());
+    } else if (it->responded && it.key()->bytesToWrite() > 0 &&
+               idle > m_limits_.write_timeout_ms) {
+      slow_writers.append(it.key());
+    }
+  }
+  for (QTcpSocket* client : slow_readers)
+    Reject(client, 408, "Request Timeout");
+  for (QTcpSocket* client : slow_writers) {
+    m_metrics_.CountRejected(408);
+    client->abort();
+  }
+  m_rate_limiter_.Prune(now);
+}
+
+void TcpServer::Reject(QTcpSocket* client, int statusCode,
+                       std::string_view statusText,
+                       const QByteArray& extraHeaders) {
+  auto it = m_clients_.find(client);
+  if (it != m_clients_.end()) it->responded = true;
+  m_route_ = Route::kOther;
+  m_parsing_ = false;
+  m_metrics_.CountRejected(statusCode);
+  m_ptxt_->append("Rejected " + client->peerAddress().toString() + ": " +
+                  QString::number(statusCode));
+  SendHttpResponse(client, statusCode, statusText,
+                   QByteArray(statusText.data(), statusText.size()),
+                   "text/plain", extraHeaders);
+}
+
 void TcpServer::OnReadyRead(QTcpSocket* client) {
-  if (!client) return;
+  auto it = m_clients_.find(client);
+  if (!client || it == m_clients_.end()) return;
+  ClientState& state = *it;
+
+  QByteArray data = client->readAll();
+  m_metrics_.AddBytesIn(data.size());
+  state.last_activity = m_clock_.elapsed();
+  if (state.responded) return;
+  state.buffer.append(data);
 
-  QByteArray request_data = client->readAll();
-  QString request(request_data);
+  if (state.header_end == -1 && !ReadHead(client, state)) return;
 
-  QStringList lines = request.split("\r\n");
-  if (lines.isEmpty()) return;
+  qsizetype body_start = state.header_end + 4;
+  if (state.buffer.size() < body_start + state.content_length) return;
 
+  state.responded = true;
+  HttpRequest request = std::move(state.request);
+  request.body = state.buffer.mid(body_start, state.content_length);
+  m_ptxt_->append("Received " + QString::number(state.buffer.size()) +
+                  " bytes from " + client->peerAddress().toString());
+  state.buffer = QByteArray();
+  // The response may close the socket and drop its state, so the state is
+  // not used past this point.
+  DispatchRequest(client, request);
+}
+
+// Parses the request line and headers once they are complete. Returns false
+// while more data is needed or after the request has been rejected.
+bool TcpServer::ReadHead(QTcpSocket* client, ClientState& state) {
+  qsizetype header_end = state.buffer.indexOf("\r\n\r\n");
+  if (header_end == -1 ? state.buffer.size() > m_limits_.max_header_bytes
+                       : header_end > m_limits_.max_header_bytes) {
+    Reject(client, 431, "Request Header Fields Too Large");
+    return false;
+  }
+  if (header_end == -1) return false;
+
+  QStringList lines =
+      QString::fromLatin1(state.buffer.left(header_end)).split("\r\n");
   QStringList request_line = lines[0].split(' ');
-  if (request_line.size() < 2) return;
+  if (request_line.size() < 2) {
+    state.responded = true;
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Malformed request line"), "text/plain");
+    return false;
+  }
+
+  state.request.method = request_line[0];
+  state.request.path = request_line[1];
+  state.request.headers = ParseHeaders(lines);
+  bool ok = true;
+  QString length = state.request.headers.value("content-length");
+  // Without a length the end of a body cannot be told apart from a slow
+  // client, so requests that carry one must declare it.
+  if (length.isEmpty() && (state.request.method == "POST" ||
+                           state.request.method == "PUT")) {
+    Reject(client, 411, "Length Required");
+    return false;
+  }
+  state.content_length = length.isEmpty() ? 0 : length.toLongLong(&ok);
+  if (!ok || state.content_length < 0) {
+    Reject(client, 400, "Bad Request");
+    return false;
+  }
+  if (state.content_length > m_limits_.max_body_bytes) {
+    Reject(client, 413, "Payload Too Large");
+    return false;
+  }
+  state.header_end = header_end;
+  return true;
+}
 
-  QString method = request_line[0];
-  QString path = request_line[1];
+void TcpServer::DispatchRequest(QTcpSocket* client,
+                                const HttpRequest& request) {
+  m_request_start_ = ServerMetrics::Now();
+  m_parsing_ = true;
+  m_route_ = RouteOf(request);
+  m_metrics_.CountRequest(m_route_);
 
-  m_ptxt_->append(method + " " + path + " from " +
+  m_ptxt_->append(request.method + " " + request.path + " from " +
                   client->peerAddress().toString());
-  m_ptxt_->append("Received " + QString::number(request_data.size()) +
-                  " bytes from " + client->peerAddress().toString());
 
-  int empty_line_idx = lines.indexOf("");
-  QByteArray body;
-  if (empty_line_idx != -1 && empty_line_idx + 1 < lines.size()) {
-    body = lines.mid(empty_line_idx + 1).join("\r\n").toUtf8();
-  }
-  if (method == "GET") {
-    ProceedGetRequest(client, path);
-  } else if (method == "OPTIONS") {
+  if (request.method == "GET") {
+    ProceedGetRequest(client, request);
+  } else if (request.method == "OPTIONS") {
     ProceedOptionRequest(client);
-  } else if (method == "POST") {
-    ProceedPostRequest(client, path, body);
-    m_ptxt_->append("POST body: " + QString(body.left(100)));
+  } else if (request.method == "POST") {
+    ProceedPostRequest(client, request);
+    if (RequestFormat(request) == WireFormat::kJson)
+      m_ptxt_->append("POST body: " + QString(request.body.left(100)));
   } else {
     SendHttpResponse(client, 405, "Method Not Allowed",
                      QByteArray("Only POST supported"), "text/plain");
   }
+  RecordPhase(Phase::kTotal, m_request_start_);
+}
+
+Route TcpServer::RouteOf(const HttpRequest& request) {
+  if (request.method == "GET") {
+    return request.path.section('?', 0, 0) == "/metrics" ? Route::kMetrics
+                                                         : Route::kStatic;
+  }
+  if (request.method == "OPTIONS") return Route::kOptions;
+  if (request.method == "POST") {
+    if (request.path == "/generate") return Route::kGenerate;
+    if (request.path == "/pass") return Route::kPass;
+    if (request.path == "/pass/batch") return Route::kBatch;
+    if (request.path == "/train") return Route::kTrain;
+    if (request.path == "/cave/generate" || request.path == "/cave/step")
+      return Route::kCave;
+  }
+  return Route::kOther;
+}
+
+// Parsing lasts from the read until compute or write starts, whichever
+// comes first.
+void TcpServer::EndParse() {
+  if (!m_parsing_) return;
+  m_parsing_ = false;
+  RecordPhase(Phase::kParse, m_request_start_);
+}
+
+void TcpServer::RecordPhase(Phase phase, int64_t since) {
+  m_metrics_.Record(m_route_, phase, ServerMetrics::Now() - since);
+}
+
+QHash<QString, QString> TcpServer::ParseHeaders(const QStringList& lines) {
+  QHash<QString, QString> headers;
+  for (qsizetype i = 1; i < lines.size(); ++i) {
+    qsizetype colon = lines[i].indexOf(':');
+    if (colon > 0) {
+      headers.insert(lines[i].left(colon).trimmed().toLower(),
+                     lines[i].mid(colon + 1).trimmed());
+    }
+  }
+  return headers;
+}
+
+WireFormat TcpServer::RequestFormat(const HttpRequest& request) {
+  return request.headers.value("content-type")
+                 .startsWith(BinaryProtocol::kContentType)
+             ? WireFormat::kBinary
+             : WireFormat::kJson;
+}
+
+WireFormat TcpServer::ResponseFormat(const HttpRequest& request) {
+  return request.headers.value("accept").contains(BinaryProtocol::kContentType)
+             ? WireFormat::kBinary
+             : WireFormat::kJson;
 }
 
-void TcpServer::ProceedGetRequest(QTcpSocket* client, const QString& path) {
-  QString filePath = "server/web" + path;
+void TcpServer::ProceedGetRequest(QTcpSocket* client,
+                                  const HttpRequest& request) {
+  QString path = request.path.section('?', 0, 0);
+  if (path == "/metrics") {
+    ProceedMetrics(client);
+    return;
+  }
 
-  if (filePath.contains("..")) {
+  if (path.contains("..")) {
     SendHttpResponse(client, 403, "Forbidden", "Access denied", "text/plain");
     return;
   }
-  if (path == "/") filePath = "server/web/index.html";
 
-  QFile file(filePath);
-  if (file.open(QIODevice::ReadOnly)) {
-    QByteArray content = file.readAll();
-    QString contentType = GetContentType(filePath);
-    SendHttpResponse(client, 200, "OK", content, contentType);
-  } else {
+  const Asset* asset = m_assets_.Find(path);
+  if (!asset) {
     SendHttpResponse(client, 404, "Not Found", "File not found", "text/plain");
+    return;
+  }
+
+  QString if_none_match = request.headers.value("if-none-match");
+  bool not_modified =
+      if_none_match.isEmpty()
+          ? request.headers.value("if-modified-since") ==
+                QString::fromLatin1(asset->last_modified)
+          : if_none_match == "*" ||
+                if_none_match.contains(QString::fromLatin1(asset->etag));
+  if (not_modified) {
+    SendNotModified(client, *asset);
+    return;
+  }
+
+  QByteArray headers = "Vary: Accept-Encoding\r\nETag: " + asset->etag +
+                       "\r\nLast-Modified: " + asset->last_modified +
+                       "\r\nCache-Control: " + asset->cache_control + "\r\n";
+  QString accept_encoding = request.headers.value("accept-encoding");
+  const QByteArray* body = &asset->content;
+  if (!asset->brotli.isEmpty() && AcceptsEncoding(accept_encoding, "br")) {
+    body = &asset->brotli;
+    headers.append("Content-Encoding: br\r\n");
+  } else if (!asset->gzip.isEmpty() &&
+             AcceptsEncoding(accept_encoding, "gzip")) {
+    body = &asset->gzip;
+    headers.append("Content-Encoding: gzip\r\n");
   }
+  SendHttpResponse(client, 200, "OK", *body,
+                   std::string_view(asset->content_type.constData(),
+                                    asset->content_type.size()),
+                   headers);
 }
+
+bool TcpServer::AcceptsEncoding(const QString& header, const QString& coding) {
+  for (const QString& item : header.split(',')) {
+    QString name = item.section(';', 0, 0).trimmed();
+    QString params = item.section(';', 1).remove(' ');
+    if (name == coding)
+      return !params.startsWith("q=") || params.mid(2).toDouble() > 0.0;
+  }
+  return false;
+}
+
+void TcpServer::SendNotModified(QTcpSocket* client, const Asset& asset) {
+  m_ptxt_->append("Sent response: 304 Not Modified");
+  WriteResponse(client, "HTTP/1.1 304 Not Modified\r\nETag: " + asset.etag +
+                            "\r\nLast-Modified: " + asset.last_modified +
+                            "\r\nCache-Control: " + asset.cache_control +
+                            "\r\nConnection: close\r\n\r\n");
+}
+
+void TcpServer::ProceedMetrics(QTcpSocket* client) {
+  QByteArray body = m_metrics_.Render();
+  body.append(
+      "# HELP maze_pass_cache_hits_total /pass responses served from cache.\n"
+      "# TYPE maze_pass_cache_hits_total counter\n"
+      "maze_pass_cache_hits_total " +
+      QByteArray::number(m_responses_.Hits()) +
+      "\n# HELP maze_pass_cache_misses_total /pass cache lookups that missed.\n"
+      "# TYPE maze_pass_cache_misses_total counter\n"
+      "maze_pass_cache_misses_total " +
+      QByteArray::number(m_responses_.Misses()) +
+      "\n# HELP maze_pass_cache_bytes Memory charged to the /pass cache.\n"
+      "# TYPE maze_pass_cache_bytes gauge\n"
+      "maze_pass_cache_bytes " +
+      QByteArray::number(m_responses_.Bytes()) +
+      "\n# HELP maze_sessions Generated mazes kept for /pass by id.\n"
+      "# TYPE maze_sessions gauge\n"
+      "maze_sessions " +
+      QByteArray::number(m_sessions_.Size()) +
+      "\n# HELP maze_session_path_bytes Memory charged to cached session "
+      "paths.\n"
+      "# TYPE maze_session_path_bytes gauge\n"
+      "maze_session_path_bytes " +
+      QByteArray::number(m_sessions_.PathBytes()) + '\n');
+  SendHttpResponse(client, 200, "OK", body,
+                   "text/plain; version=0.0.4; charset=utf-8",
+                   "Cache-Control: no-store\r\n");
+}
+
 void TcpServer::ProceedOptionRequest(QTcpSocket* client) {
   m_ptxt_->append("OPTIONS request processed for " +
                   client->peerAddress().toString());
@@ -118,54 +408,62 @@ void TcpServer::ProceedOptionRequest(QTcpSocket* client) {
   response.append("HTTP/1.1 204 No Content\r\n");
   response.append("Access-Control-Allow-Origin: *\r\n");
   response.append("Access-Control-Allow-Methods: POST, OPTIONS\r\n");
-  response.append("Access-Control-Allow-Headers: Content-Type\r\n");
+  response.append("Access-Control-Allow-Headers: Content-Type, Accept\r\n");
   response.append("Access-Control-Max-Age: 86400\r\n");
   response.append("Connection: close\r\n\r\n");
-  client->write(response);
-  client->flush();
-  client->disconnectFromHost();
+  WriteResponse(client, response);
 }
 
-void TcpServer::ProceedPostRequest(QTcpSocket* client, const QString& path,
-                                   const QByteArray& body) {
-  m_ptxt_->append("POST to " + path + " from " +
+void TcpServer::ProceedPostRequest(QTcpSocket* client,
+                                   const HttpRequest& request) {
+  m_ptxt_->append("POST to " + request.path + " from " +
                   client->peerAddress().toString());
-  if (path == "/generate") {
-    ProceedGenerate(client, body);
-  } else if (path == "/pass") {
-    ProceedPath(client, body);
+  if (request.path == "/generate") {
+    ProceedGenerate(client, request);
+  } else if (request.path == "/pass") {
+    ProceedPath(client, request);
+  } else if (request.path == "/pass/batch") {
+    ProceedBatch(client, request);
+  } else if (request.path == "/train") {
+    ProceedTrain(client, request);
+  } else if (request.path == "/cave/generate" ||
+             request.path == "/cave/step") {
+    ProceedCave(client, request);
   } else {
     SendHttpResponse(client, 404, "Not Found", QByteArray("Path not found"),
                      "text/plain");
-    m_ptxt_->append("POST: Unknown path " + path);
+    m_ptxt_->append("POST: Unknown path " + request.path);
   }
 }
 
-QString TcpServer::GetContentType(const QString& filePath) {
-  if (filePath.endsWith(".html")) return "text/html";
-  if (filePath.endsWith(".css")) return "text/css";
-  if (filePath.endsWith(".js")) return "application/javascript";
-  if (filePath.endsWith(".svg")) return "image/svg+xml";
-  return "text/plain";
-}
+void TcpServer::ProceedGenerate(QTcpSocket* client,
+                                const HttpRequest& request) {
+  int rows = -1;
+  int cols = -1;
+  if (RequestFormat(request) == WireFormat::kBinary) {
+    if (!BinaryProtocol::ReadSize(request.body, rows, cols)) {
+      SendHttpResponse(client, 400, "Bad Request",
+                       QByteArray("Invalid binary request"), "text/plain");
+      return;
+    }
+  } else {
+    QJsonDocument doc = QJsonDocument::fromJson(request.body);
+    if (!doc.isObject()) {
+      SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid JSON"),
+                       "text/plain");
+      return;
+    }
+    QJsonObject obj = doc.object();
 
-void TcpServer::ProceedGenerate(QTcpSocket* client, const QByteArray& body) {
-  QJsonDocument doc = QJsonDocument::fromJson(body);
-  if (!doc.isObject()) {
-    SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid JSON"),
-                     "text/plain");
-    return;
-  }
-  QJsonObject obj = doc.object();
+    if (!obj.contains("rows") || !obj.contains("cols")) {
+      SendHttpResponse(client, 400, "Bad Request",
+                       QByteArray("Missing rows or cols"), "text/plain");
+      return;
+    }
 
-  if (!obj.contains("rows") || !obj.contains("cols")) {
-    SendHttpResponse(client, 400, "Bad Request",
-                     QByteArray("Missing rows or cols"), "text/plain");
-    return;
+    rows = obj.value("rows").toInt(-1);
+    cols = obj.value("cols").toInt(-1);
   }
-
-  int rows = obj.value("rows").toInt(-1);
-  int cols = obj.value("cols").toInt(-1);
   m_ptxt_->append("Generating maze: rows=" + QString::number(rows) +
                   ", cols=" + QString::number(cols));
 
@@ -176,55 +474,69 @@ void TcpServer::ProceedGenerate(QTcpSocket* client, const QByteArray& body) {
 
     return;
   }
-  SendGeneratedMaze(client, rows, cols);
+  SendGeneratedMaze(client, rows, cols, ResponseFormat(request));
 }
 
-void TcpServer::SendGeneratedMaze(QTcpSocket* client, int rows, int cols) {
+void TcpServer::SendGeneratedMaze(QTcpSocket* client, int rows, int cols,
+                                  WireFormat format) {
+  EndParse();
+  int64_t compute_start = ServerMetrics::Now();
   Maze maze(rows, cols);
   maze.GenerateMaze();
+  RecordPhase(Phase::kCompute, compute_start);
+  quint64 id = m_sessions_.Insert(maze);
 
-  QJsonObject responseObj;
-  QJsonArray verticals_array;
-  QJsonArray horizontals_array;
-
-  auto verticals = maze.GetVerticals();
-  auto horizontals = maze.GetHorizontals();
-
-  for (int i = 0; i < rows; ++i) {
-    verticals_array.append(QString::number(verticals[i]));
-    horizontals_array.append(QString::number(horizontals[i]));
+  if (format == WireFormat::kBinary) {
+    SendHttpResponse(client, 200, "OK", BinaryProtocol::WriteMaze(maze, id),
+                     BinaryProtocol::kContentType);
+    m_ptxt_->append("Maze sent to " + client->peerAddress().toString());
+    return;
   }
 
-  responseObj["verticals"] = verticals_array;
-  responseObj["horizontals"] = horizontals_array;
-
-  QJsonDocument responseDoc(responseObj);
-  QByteArray responseData = responseDoc.toJson();
-
+  QByteArray responseData;
+  ResponseWriter::WriteMaze(responseData, maze, id);
   SendHttpResponse(client, 200, "OK", responseData, "application/json");
   m_ptxt_->append("Maze sent to " + client->peerAddress().toString());
 }
 
-void TcpServer::ProceedPath(QTcpSocket* client, const QByteArray& body) {
-  QJsonDocument doc = QJsonDocument::fromJson(body);
-  if (!doc.isObject()) {
-    SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid JSON"),
-                     "text/plain");
-    return;
+void TcpServer::ProceedPath(QTcpSocket* client, const HttpRequest& request) {
+  int rows = -1;
+  int cols = -1;
+  Cell start{-1, -1};
+  Cell end{-1, -1};
+  std::array<uint64_t, kMaxSize> verticals{};
+  std::array<uint64_t, kMaxSize> horizontals{};
+
+  if (RequestFormat(request) == WireFormat::kBinary) {
+    if (!BinaryProtocol::ReadPathRequest(request.body, rows, cols, start, end,
+                                         verticals, horizontals)) {
+      SendHttpResponse(client, 400, "Bad Request",
+                       QByteArray("Invalid binary request"), "text/plain");
+      return;
+    }
+  } else {
+    QJsonDocument doc = QJsonDocument::fromJson(request.body);
+    if (!doc.isObject()) {
+      SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid JSON"),
+                       "text/plain");
+      return;
+    }
+    QJsonObject obj = doc.object();
+    if (obj.contains("id")) {
+      ProceedSessionPath(client, obj, ResponseFormat(request));
+      return;
+    }
+    if (!ParseJsonPath(client, obj, rows, cols, start, end, verticals,
+                       horizontals))
+      return;
   }
-  QJsonObject obj = doc.object();
-  if (!ValidJson(client, obj)) return;
 
-  int rows = obj.value("rows").toInt(-1);
-  int cols = obj.value("cols").toInt(-1);
   if (rows <= 0 || cols <= 0 || rows > kMaxSize || cols > kMaxSize) {
     SendHttpResponse(client, 400, "Bad Request",
                      QByteArray("Invalid rows or cols"), "text/plain");
     return;
   }
 
-  auto start = GetPoint(obj, "start");
-  auto end = GetPoint(obj, "end");
   m_ptxt_->append("Path request: start=(" + QString::number(start.r) + "," +
                   QString::number(start.c) + "), end=(" +
                   QString::number(end.r) + "," + QString::number(end.c) + ")");
@@ -235,17 +547,103 @@ void TcpServer::ProceedPath(QTcpSocket* client, const QByteArray& body) {
     return;
   }
 
+  WireFormat format = ResponseFormat(request);
+  QByteArray key =
+      ResponseCache::Key(rows, cols, verticals, horizontals, start, end,
+                         static_cast<char>(format));
+  if (const QByteArray* cached = m_responses_.Find(key)) {
+    SendHttpResponse(client, 200, "OK", *cached, ContentType(format));
+    m_ptxt_->append("Cached response sent, hits: " +
+                    QString::number(m_responses_.Hits()) +
+                    ", misses: " + QString::number(m_responses_.Misses()));
+    return;
+  }
+
+  EndParse();
+  int64_t compute_start = ServerMetrics::Now();
+  Maze maze(rows, cols);
+  maze.SetVerticals(verticals);
+  maze.SetHorizontals(horizontals);
+
+  bool found = maze.SolveMaze(start, end, m_pass_);
+  RecordPhase(Phase::kCompute, compute_start);
+  if (found) {
+    QByteArray body = EncodePass(m_pass_, format);
+    m_responses_.Insert(key, body);
+    SendHttpResponse(client, 200, "OK", body, ContentType(format));
+  } else {
+    SendPassResponce(client, m_pass_, format);
+  }
+  m_ptxt_->append("Path found, length: " + QString::number(m_pass_.size()));
+}
+
+void TcpServer::ProceedSessionPath(QTcpSocket* client, const QJsonObject& obj,
+                                   WireFormat format) {
+  bool ok = false;
+  quint64 id = obj.value("id").toString().toULongLong(&ok, 16);
+  MazeSession* session = ok ? m_sessions_.Find(id) : nullptr;
+  if (!session) {
+    SendHttpResponse(client, 404, "Not Found", QByteArray("Unknown maze id"),
+                     "text/plain");
+    return;
+  }
+
+  auto start = GetPoint(obj, "start");
+  auto end = GetPoint(obj, "end");
+  int rows = session->maze.GetRows();
+  int cols = session->maze.GetCols();
+  if (!ValidPoint(start, rows, cols) || !ValidPoint(end, rows, cols)) {
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Invalid start or end"), "text/plain");
+    return;
+  }
+
+  quint32 key = SessionStore::PathKey(start, end);
+  if (const std::vector<Cell>* cached = m_sessions_.FindPath(*session, key)) {
+    SendPassResponce(client, *cached, format);
+    m_ptxt_->append("Cached path sent, length: " +
+                    QString::number(cached->size()));
+    return;
+  }
+  EndParse();
+  int64_t compute_start = ServerMetrics::Now();
+  session->maze.SolveMaze(start, end, m_pass_);
+  RecordPhase(Phase::kCompute, compute_start);
+  m_sessions_.StorePath(*session, key, m_pass_);
+  SendPassResponce(client, m_pass_, format);
+  m_ptxt_->append("Path found, length: " + QString::number(m_pass_.size()));
+}
+
+bool TcpServer::ParseJsonPath(QTcpSocket* client, const QJsonObject& obj,
+                              int& rows, int& cols, Cell& start, Cell& end,
+                              std::array<uint64_t, kMaxSize>& verticals,
+                              std::array<uint64_t, kMaxSize>& horizontals) {
+  if (!ValidJson(client, obj)) return false;
+  start = GetPoint(obj, "start");
+  end = GetPoint(obj, "end");
+  return ParseJsonWalls(client, obj, rows, cols, verticals, horizontals);
+}
+
+bool TcpServer::ParseJsonWalls(QTcpSocket* client, const QJsonObject& obj,
+                               int& rows, int& cols,
+                               std::array<uint64_t, kMaxSize>& verticals,
+                               std::array<uint64_t, kMaxSize>& horizontals) {
+  rows = obj.value("rows").toInt(-1);
+  cols = obj.value("cols").toInt(-1);
+  if (rows <= 0 || cols <= 0 || rows > kMaxSize || cols > kMaxSize) {
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Invalid rows or cols"), "text/plain");
+    return false;
+  }
+
   QJsonArray verticals_array = obj.value("verticals").toArray();
   QJsonArray horizontals_array = obj.value("horizontals").toArray();
   if (verticals_array.size() < rows || horizontals_array.size() < rows) {
     SendHttpResponse(client, 400, "Bad Request",
                      QByteArray("Invalid walls arrays"), "text/plain");
-    return;
+    return false;
   }
 
-  std::array<uint64_t, kMaxSize> verticals{};
-  std::array<uint64_t, kMaxSize> horizontals{};
-
   for (int i = 0; i < rows; ++i) {
     bool ok1 = false, ok2 = false;
     uint64_t v = verticals_array[i].toString().toULongLong(&ok1);
@@ -253,19 +651,363 @@ void TcpServer::ProceedPath(QTcpSocket* client, const QByteArray& body) {
     if (!ok1 || !ok2) {
       SendHttpResponse(client, 400, "Bad Request",
                        QByteArray("Invalid wall data"), "text/plain");
-      return;
+      return false;
     }
     verticals[i] = v;
     horizontals[i] = h;
   }
+  return true;
+}
 
-  Maze maze(rows, cols);
-  maze.SetVerticals(verticals);
-  maze.SetHorizontals(horizontals);
+void TcpServer::ProceedBatch(QTcpSocket* client, const HttpRequest& request) {
+  Maze maze;
+  std::vector<std::pair<Cell, Cell>> queries;
+
+  if (RequestFormat(request) == WireFormat::kBinary) {
+    int rows = -1;
+    int cols = -1;
+    std::array<uint64_t, kMaxSize> verticals{};
+    std::array<uint64_t, kMaxSize> horizontals{};
+    if (!BinaryProtocol::ReadBatchRequest(request.body, rows, cols, verticals,
+                                          horizontals, queries) ||
+        !maze.SetRowsCols(rows, cols)) {
+      SendHttpResponse(client, 400, "Bad Request",
+                       QByteArray("Invalid binary request"), "text/plain");
+      return;
+    }
+    maze.SetVerticals(verticals);
+    maze.SetHorizontals(horizontals);
+  } else {
+    QJsonDocument doc = QJsonDocument::fromJson(request.body);
+    if (!doc.isObject()) {
+      SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid JSON"),
+                       "text/plain");
+      return;
+    }
+    if (!ParseJsonBatch(client, doc.object(), maze, queries)) return;
+  }
 
-  auto pass = maze.SolveMaze(start, end);
-  SendPassResponce(client, pass);
-  m_ptxt_->append("Path found, length: " + QString::number(pass.size()));
+  if (queries.empty()) {
+    SendHttpResponse(client, 400, "Bad Request", QByteArray("No queries"),
+                     "text/plain");
+    return;
+  }
+  if (static_cast<qsizetype>(queries.size()) > kMaxBatchQueries) {
+    SendHttpResponse(client, 413, "Payload Too Large",
+                     QByteArray("Too many queries"), "text/plain");
+    return;
+  }
+  for (const auto& [start, end] : queries) {
+    if (!ValidPoint(start, maze.GetRows(), maze.GetCols()) ||
+        !ValidPoint(end, maze.GetRows(), maze.GetCols())) {
+      SendHttpResponse(client, 400, "Bad Request",
+                       QByteArray("Invalid start or end"), "text/plain");
+      return;
+    }
+  }
+
+  EndParse();
+  int64_t compute_start = ServerMetrics::Now();
+  // Threads are started per request, so a batch gets one per
+  // kBatchQueriesPerThread queries and small batches stay on this thread.
+  unsigned threads = std::clamp<size_t>(
+      queries.size() / kBatchQueriesPerThread, 1,
+      std::max(1u, std::thread::hardware_concurrency()));
+  auto passes = maze.SolveMazeBatch(queries, threads);
+  RecordPhase(Phase::kCompute, compute_start);
+
+  SendBatchResponse(client, passes, ResponseFormat(request));
+  m_ptxt_->append("Batch solved, queries: " + QString::number(passes.size()));
+}
+
+bool TcpServer::ParseJsonBatch(QTcpSocket* client, const QJsonObject& obj,
+                               Maze& maze,
+                               std::vector<std::pair<Cell, Cell>>& queries) {
+  if (obj.contains("id")) {
+    bool ok = false;
+    quint64 id = obj.value("id").toString().toULongLong(&ok, 16);
+    MazeSession* session = ok ? m_sessions_.Find(id) : nullptr;
+    if (!session) {
+      SendHttpResponse(client, 404, "Not Found",
+                       QByteArray("Unknown maze id"), "text/plain");
+      return false;
+    }
+    maze = session->maze;
+  } else {
+    int rows = -1;
+    int cols = -1;
+    std::array<uint64_t, kMaxSize> verticals{};
+    std::array<uint64_t, kMaxSize> horizontals{};
+    if (!ParseJsonWalls(client, obj, rows, cols, verticals, horizontals))
+      return false;
+    maze.SetRowsCols(rows, cols);
+    maze.SetVerticals(verticals);
+    maze.SetHorizontals(horizontals);
+  }
+
+  // A missing or non-array field reads as an empty array.
+  QJsonArray pairs = obj.value("pairs").toArray();
+  if (pairs.isEmpty()) {
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Missing or empty pairs"), "text/plain");
+    return false;
+  }
+  queries.reserve(std::min(pairs.size(), kMaxBatchQueries + 1));
+  for (const auto& value : pairs) {
+    if (static_cast<qsizetype>(queries.size()) > kMaxBatchQueries) break;
+    QJsonObject pair = value.toObject();
+    queries.push_back({GetPoint(pair, "start"), GetPoint(pair, "end")});
+  }
+  return true;
+}
+
+// Results are streamed in query order with chunked transfer encoding, so the
+// client can start reading before the whole body is serialized.
+void TcpServer::SendBatchResponse(QTcpSocket* client,
+                                  const std::vector<std::vector<Cell>>& passes,
+                                  WireFormat format) {
+  m_ptxt_->append("Sent response: 200 OK (chunked)");
+  EndParse();
+  int64_t write_start = ServerMetrics::Now();
+  std::string_view content_type = ContentType(format);
+  QByteArray header =
+      "HTTP/1.1 200 OK\r\nContent-Type: " +
+      QByteArray(content_type.data(), content_type.size()) +
+      "\r\nTransfer-Encoding: chunked\r\n"
+      "Access-Control-Allow-Origin: *\r\n"
+      "Connection: close\r\n\r\n";
+  client->write(header);
+  m_metrics_.AddBytesOut(header.size());
+
+  QByteArray buffer;
+  buffer.reserve(kBatchChunkBytes + 1024);
+  if (format == WireFormat::kBinary) {
+    BinaryProtocol::AppendCount(buffer, passes.size());
+    for (const auto& pass : passes) {
+      BinaryProtocol::AppendPath(buffer, pass);
+      if (buffer.size() >= kBatchChunkBytes) WriteChunk(client, buffer);
+    }
+  } else {
+    JsonWriter<QByteArray> json(buffer);
+    json.BeginObject();
+    json.Key("passes");
+    json.BeginArray();
+    for (const auto& pass : passes) {
+      ResponseWriter::WritePath(json, pass);
+      if (buffer.size() >= kBatchChunkBytes) WriteChunk(client, buffer);
+    }
+    json.EndArray();
+    json.EndObject();
+  }
+  WriteChunk(client, buffer);
+  client->write("0\r\n\r\n");
+  m_metrics_.AddBytesOut(5);
+  client->flush();
+  client->disconnectFromHost();
+  RecordPhase(Phase::kWrite, write_start);
+}
+
+void TcpServer::WriteChunk(QTcpSocket* client, QByteArray& data) {
+  if (data.isEmpty()) return;
+  QByteArray size = QByteArray::number(data.size(), 16) + "\r\n";
+  client->write(size);
+  client->write(data);
+  client->write("\r\n");
+  m_metrics_.AddBytesOut(size.size() + data.size() + 2);
+  // The socket holds its own reference to the written data.
+  data.resize(0);
+}
+
+void TcpServer::ProceedTrain(QTcpSocket* client, const HttpRequest& request) {
+  QJsonDocument doc = QJsonDocument::fromJson(request.body);
+  if (!doc.isObject()) {
+    SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid JSON"),
+                     "text/plain");
+    return;
+  }
+  QJsonObject obj = doc.object();
+
+  Maze maze;
+  if (obj.contains("id")) {
+    bool ok = false;
+    quint64 id = obj.value("id").toString().toULongLong(&ok, 16);
+    MazeSession* session = ok ? m_sessions_.Find(id) : nullptr;
+    if (!session) {
+      SendHttpResponse(client, 404, "Not Found",
+                       QByteArray("Unknown maze id"), "text/plain");
+      return;
+    }
+    maze = session->maze;
+  } else {
+    int rows = -1;
+    int cols = -1;
+    std::array<uint64_t, kMaxSize> verticals{};
+    std::array<uint64_t, kMaxSize> horizontals{};
+    if (!ParseJsonWalls(client, obj, rows, cols, verticals, horizontals))
+      return;
+    maze.SetRowsCols(rows, cols);
+    maze.SetVerticals(verticals);
+    maze.SetHorizontals(horizontals);
+  }
+
+  Cell start = GetPoint(obj, "start");
+  Cell goal = GetPoint(obj, "end");
+  if (!ValidPoint(start, maze.GetRows(), maze.GetCols()) ||
+      !ValidPoint(goal, maze.GetRows(), maze.GetCols())) {
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Invalid start or end"), "text/plain");
+    return;
+  }
+  if (m_trainings_ >= kMaxTrainings) {
+    SendHttpResponse(client, 503, "Service Unavailable",
+                     QByteArray("Training capacity reached"), "text/plain",
+                     "Retry-After: 5\r\n");
+    return;
+  }
+
+  // The connection stays open and the body ends when it closes, so no
+  // Content-Length or chunked framing is needed for the event stream.
+  EndParse();
+  int64_t write_start = ServerMetrics::Now();
+  QByteArray header =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: text/event-stream\r\n"
+      "Cache-Control: no-cache\r\n"
+      "Access-Control-Allow-Origin: *\r\n"
+      "Connection: close\r\n\r\n";
+  client->write(header);
+  client->flush();
+  m_metrics_.AddBytesOut(header.size());
+  RecordPhase(Phase::kWrite, write_start);
+
+  auto* training = new TrainingSession(maze, start, goal, client, this);
+  ++m_trainings_;
+  connect(training, &QObject::destroyed, this, [this]() { --m_trainings_; });
+  connect(training, &TrainingSession::BytesSent, this,
+          [this](qint64 bytes) { m_metrics_.AddBytesOut(bytes); });
+  training->Start();
+  m_ptxt_->append("Training started for " + client->peerAddress().toString());
+}
+
+// /cave/generate fills a new cave with the given chance, /cave/step takes
+// the packed rows in "cells". Both then run all requested steps here, so a
+// client needs one round-trip instead of one per generation.
+void TcpServer::ProceedCave(QTcpSocket* client, const HttpRequest& request) {
+  QJsonDocument doc = QJsonDocument::fromJson(request.body);
+  if (!doc.isObject()) {
+    SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid JSON"),
+                     "text/plain");
+    return;
+  }
+  QJsonObject obj = doc.object();
+
+  int rows = obj.value("rows").toInt(-1);
+  int cols = obj.value("cols").toInt(-1);
+  if (rows <= 0 || cols <= 0 || rows > kMaxSize || cols > kMaxSize) {
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Invalid rows or cols"), "text/plain");
+    return;
+  }
+  int birth = 0;
+  int death = 0;
+  int steps = 0;
+  int radius = 1;
+  if (!ParseCaveRules(client, obj, birth, death, steps, radius)) return;
+  // Optional post-processing: fill smaller regions, tunnel the rest together.
+  int min_region = obj.value("min_region").toInt(-1);
+  if (obj.contains("min_region") && min_region < 0) {
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Invalid min_region"), "text/plain");
+    return;
+  }
+
+  bool generate = request.path == "/cave/generate";
+  double chance = obj.value("chance").toDouble(-1.0);
+  std::array<uint64_t, kMaxSize> cells{};
+  if (generate) {
+    if (chance < 0.0 || chance > 1.0) {
+      SendHttpResponse(client, 400, "Bad Request",
+                       QByteArray("Invalid chance"), "text/plain");
+      return;
+    }
+  } else {
+    QJsonArray rows_array = obj.value("cells").toArray();
+    if (rows_array.size() < rows) {
+      SendHttpResponse(client, 400, "Bad Request",
+                       QByteArray("Invalid cells array"), "text/plain");
+      return;
+    }
+    for (int i = 0; i < rows; ++i) {
+      bool ok = false;
+      cells[i] = rows_array[i].toString().toULongLong(&ok);
+      if (!ok) {
+        SendHttpResponse(client, 400, "Bad Request",
+                         QByteArray("Invalid cell data"), "text/plain");
+        return;
+      }
+    }
+  }
+
+  EndParse();
+  int64_t compute_start = ServerMetrics::Now();
+  Maze cave(rows, cols);
+  if (generate)
+    cave.GenerateCave(chance);
+  else
+    cave.SetVerticals(cells);
+  // Running until stable also stops once the cave starts to oscillate.
+  CaveRun run{0, 0};
+  if (obj.value("until_stable").toBool()) {
+    run = cave.RunCaveToStable(birth, death, steps, radius);
+  } else if (radius > 1) {
+    while (run.steps < steps && run.period == 0) {
+      run.period = cave.SolveCaveRadius(birth, death, radius) ? 1 : 0;
+      ++run.steps;
+    }
+  } else {
+    bool stable = false;
+    run.steps = cave.SolveCaveSteps(birth, death, steps, stable);
+    run.period = stable ? 1 : 0;
+  }
+  if (min_region >= 0) cave.ConnectCave(min_region);
+  RecordPhase(Phase::kCompute, compute_start);
+
+  SendCave(client, cave, run);
+  m_ptxt_->append("Cave sent after " + QString::number(run.steps) + " steps");
+}
+
+bool TcpServer::ParseCaveRules(QTcpSocket* client, const QJsonObject& obj,
+                               int& birth, int& death, int& steps,
+                               int& radius) {
+  radius = obj.value("radius").toInt(1);
+  if (radius < 1 || radius > kMaxCaveRadius) {
+    SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid radius"),
+                     "text/plain");
+    return false;
+  }
+  int neighbours = (2 * radius + 1) * (2 * radius + 1) - 1;
+  birth = obj.value("birth").toInt(-1);
+  death = obj.value("death").toInt(-1);
+  if (birth < 0 || birth > neighbours || death < 0 || death > neighbours) {
+    SendHttpResponse(client, 400, "Bad Request",
+                     QByteArray("Invalid birth or death"), "text/plain");
+    return false;
+  }
+  steps = obj.value("until_stable").toBool() ? kMaxCaveSteps
+                                             : obj.value("steps").toInt(0);
+  if (steps < 0 || steps > kMaxCaveSteps) {
+    SendHttpResponse(client, 400, "Bad Request", QByteArray("Invalid steps"),
+                     "text/plain");
+    return false;
+  }
+  return true;
+}
+
+void TcpServer::SendCave(QTcpSocket* client, const Maze& cave,
+                         const CaveRun& run) {
+  QByteArray responseData;
+  ResponseWriter::WriteCave(responseData, cave, run);
+  SendHttpResponse(client, 200, "OK", responseData, "application/json");
 }
 
 Cell TcpServer::GetPoint(const QJsonObject& obj, const QString& point) {
@@ -277,51 +1019,58 @@ Cell TcpServer::GetPoint(const QJsonObject& obj, const QString& point) {
 }
 
 void TcpServer::SendPassResponce(QTcpSocket* client,
-                                 const std::vector<Cell>& pass) {
+                                 const std::vector<Cell>& pass,
+                                 WireFormat format) {
   if (!pass.size()) {
     SendHttpResponse(client, 404, "Not Found", QByteArray("Path not found"),
                      "text/plain");
     return;
   }
+  SendHttpResponse(client, 200, "OK", EncodePass(pass, format),
+                   ContentType(format));
+}
 
-  QJsonArray passArray;
-  for (const auto& p : pass) {
-    QJsonArray coord;
-    coord.append(p.r);
-    coord.append(p.c);
-    passArray.append(coord);
-  }
-
-  QJsonObject responseObj;
-  responseObj["pass"] = passArray;
+QByteArray TcpServer::EncodePass(const std::vector<Cell>& pass,
+                                 WireFormat format) {
+  if (format == WireFormat::kBinary) return BinaryProtocol::WritePath(pass);
 
-  QJsonDocument responseDoc(responseObj);
-  QByteArray responseData = responseDoc.toJson();
+  QByteArray responseData;
+  ResponseWriter::WritePass(responseData, pass);
+  return responseData;
+}
 
-  SendHttpResponse(client, 200, "OK", responseData, "application/json");
+std::string_view TcpServer::ContentType(WireFormat format) {
+  return format == WireFormat::kBinary ? BinaryProtocol::kContentType
+                                       : "application/json";
 }
 
 void TcpServer::SendHttpResponse(QTcpSocket* client, int statusCode,
-                                 const QString& statusText,
+                                 std::string_view statusText,
                                  const QByteArray& body,
-                                 const QString& contentType) {
+                                 std::string_view contentType,
+                                 const QByteArray& extraHeaders) {
   m_ptxt_->append("Sent response: " + QString::number(statusCode) + " " +
-                  statusText);
+                  QString::fromLatin1(statusText.data(), statusText.size()));
 
-  QByteArray response;
-  response.append("HTTP/1.1 " + QByteArray::number(statusCode) + " " +
-                  statusText.toUtf8() + "\r\n");
-  response.append("Content-Type: " + contentType.toUtf8() + "\r\n");
-  response.append("Content-Length: " + QByteArray::number(body.size()) +
-                  "\r\n");
-  response.append("Access-Control-Allow-Origin: *\r\n");
-  response.append("Connection: close\r\n");
-  response.append("\r\n");
-  response.append(body);
+  QByteArray header;
+  ResponseWriter::WriteHeader(
+      header, statusCode, statusText, contentType, body.size(),
+      std::string_view(extraHeaders.constData(), extraHeaders.size()));
+  WriteResponse(client, header, body);
+}
 
-  client->write(response);
+void TcpServer::WriteResponse(QTcpSocket* client, const QByteArray& header,
+                              const QByteArray& body) {
+  EndParse();
+  int64_t write_start = ServerMetrics::Now();
+  // Header and body are queued separately instead of being concatenated;
+  // the socket shares large bodies with its write buffer without copying.
+  client->write(header);
+  if (!body.isEmpty()) client->write(body);
   client->flush();
   client->disconnectFromHost();
+  m_metrics_.AddBytesOut(header.size() + body.size());
+  RecordPhase(Phase::kWrite, write_start);
 }
 
 bool TcpServer::ValidJson(QTcpSocket* client, const QJsonObject& obj) {
@@ -4,6 +4,8 @@
 #include <QByteArray>
 #include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -11,43 +13,128 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QTextEdit>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <string_view>
 
 #include "../model/maze/maze.h"
+#include "admission.h"
+#include "asset_cache.h"
+#include "binary_protocol.h"
+#include "metrics.h"
+#include "response_cache.h"
+#include "session_store.h"
+#include "training_session.h"
+
+enum class WireFormat { kJson, kBinary };
+
+struct HttpRequest {
+  QString method;
+  QString path;
+  QHash<QString, QString> headers;
+  QByteArray body;
+};
+
+struct ClientState {
+  QByteArray buffer;
+  HttpRequest request;
+  qsizetype header_end = -1;
+  qsizetype content_length = 0;
+  qint64 last_activity = 0;
+  bool responded = false;
+};
 
 class TcpServer : public QWidget {
   Q_OBJECT
 
  public:
-  explicit TcpServer(quint16 port, QWidget* parent = nullptr);
+  explicit TcpServer(quint16 port, QWidget* parent = nullptr,
+                     bool watch_assets = false,
+                     const ServerLimits& limits = ServerLimits());
   ~TcpServer();
 
  private slots:
   void OnNewConnection();
   void OnReadyRead(QTcpSocket* client);
   void OnClientDisconnected(QTcpSocket* client_socket);
+  void OnSweep();
 
  private:
+  bool AdmitConnection(QTcpSocket* client);
+  bool ReadHead(QTcpSocket* client, ClientState& state);
+  void DispatchRequest(QTcpSocket* client, const HttpRequest& request);
+  void Reject(QTcpSocket* client, int statusCode,
+              std::string_view statusText,
+              const QByteArray& extraHeaders = QByteArray());
   bool ValidJson(QTcpSocket* client, const QJsonObject& obj);
   Cell GetPoint(const QJsonObject& obj, const QString& point);
   static bool ValidPoint(const Cell& point, const int& rows, const int& cols);
-  void SendPassResponce(QTcpSocket* client, const std::vector<Cell>& pass);
-  QString GetContentType(const QString& filePath);
-  void ProceedPostRequest(QTcpSocket* client, const QString& path,
-                          const QByteArray& body);
+  void SendPassResponce(QTcpSocket* client, const std::vector<Cell>& pass,
+                        WireFormat format);
+  static QByteArray EncodePass(const std::vector<Cell>& pass,
+                               WireFormat format);
+  static std::string_view ContentType(WireFormat format);
+  static QHash<QString, QString> ParseHeaders(const QStringList& lines);
+  static WireFormat RequestFormat(const HttpRequest& request);
+  static WireFormat ResponseFormat(const HttpRequest& request);
+  void ProceedPostRequest(QTcpSocket* client, const HttpRequest& request);
   void ProceedOptionRequest(QTcpSocket* client);
-  void ProceedGetRequest(QTcpSocket* client, const QString& path);
-  void SendGeneratedMaze(QTcpSocket* client, int rows, int cols);
-  void ProceedGenerate(QTcpSocket* client, const QByteArray& body);
-  void ProceedPath(QTcpSocket* client, const QByteArray& body);
+  void ProceedGetRequest(QTcpSocket* client, const HttpRequest& request);
+  void ProceedMetrics(QTcpSocket* client);
+  static Route RouteOf(const HttpRequest& request);
+  void EndParse();
+  void RecordPhase(Phase phase, int64_t since);
+  static bool AcceptsEncoding(const QString& header, const QString& coding);
+  void SendNotModified(QTcpSocket* client, const Asset& asset);
+  void SendGeneratedMaze(QTcpSocket* client, int rows, int cols,
+                         WireFormat format);
+  void ProceedGenerate(QTcpSocket* client, const HttpRequest& request);
+  void ProceedPath(QTcpSocket* client, const HttpRequest& request);
+  void ProceedSessionPath(QTcpSocket* client, const QJsonObject& obj,
+                          WireFormat format);
+  bool ParseJsonPath(QTcpSocket* client, const QJsonObject& obj, int& rows,
+                     int& cols, Cell& start, Cell& end,
+                     std::array<uint64_t, kMaxSize>& verticals,
+                     std::array<uint64_t, kMaxSize>& horizontals);
+  bool ParseJsonWalls(QTcpSocket* client, const QJsonObject& obj, int& rows,
+                      int& cols, std::array<uint64_t, kMaxSize>& verticals,
+                      std::array<uint64_t, kMaxSize>& horizontals);
+  void ProceedBatch(QTcpSocket* client, const HttpRequest& request);
+  bool ParseJsonBatch(QTcpSocket* client, const QJsonObject& obj, Maze& maze,
+                      std::vector<std::pair<Cell, Cell>>& queries);
+  void SendBatchResponse(QTcpSocket* client,
+                         const std::vector<std::vector<Cell>>& passes,
+                         WireFormat format);
+  void WriteChunk(QTcpSocket* client, QByteArray& data);
+  void ProceedTrain(QTcpSocket* client, const HttpRequest& request);
+  void ProceedCave(QTcpSocket* client, const HttpRequest& request);
+  bool ParseCaveRules(QTcpSocket* client, const QJsonObject& obj, int& birth,
+                      int& death, int& steps, int& radius);
+  void SendCave(QTcpSocket* client, const Maze& cave, const CaveRun& run);
   void SendHttpResponse(QTcpSocket* client, int statusCode,
-                        const QString& statusText, const QByteArray& body,
-                        const QString& contentType);
+                        std::string_view statusText, const QByteArray& body,
+                        std::string_view contentType,
+                        const QByteArray& extraHeaders = QByteArray());
+  void WriteResponse(QTcpSocket* client, const QByteArray& header,
+                     const QByteArray& body = QByteArray());
 
   QTcpServer* m_ptcp_server_;
   QTextEdit* m_ptxt_;
-  QList<QTcpSocket*> m_clients_;
+  QHash<QTcpSocket*, ClientState> m_clients_;
+  ServerLimits m_limits_;
+  RateLimiter m_rate_limiter_;
+  QElapsedTimer m_clock_;
+  QTimer* m_psweep_timer_;
+  AssetCache m_assets_;
+  SessionStore m_sessions_;
+  ResponseCache m_responses_;
+  ServerMetrics m_metrics_;
+  Route m_route_;
+  int64_t m_request_start_;
+  bool m_parsing_;
+  int m_trainings_;
+  std::vector<Cell> m_pass_;  // path buffer reused by /pass solves
 };
 
 #endif  // TCPSERVER_H
@@ -0,0 +1,82 @@
+#include "training_session.h"
+
+#include "json_writer.h"
+
+TrainingSession::TrainingSession(const Maze& maze, Cell start, Cell goal,
+                                 QTcpSocket* client, QObject* parent)
+    : QObject(parent),
+      m_maze_(maze),
+      m_start_(start),
+      m_goal_(goal),
+      m_pthread_(nullptr),
+      m_pclient_(client) {
+  m_agent_.Init(&m_maze_, m_goal_);
+  connect(&m_agent_, &QLearning::Progress, this, &TrainingSession::OnProgress);
+  connect(client, &QTcpSocket::disconnected, &m_agent_,
+          &QLearning::StopLearning);
+}
+
+TrainingSession::~TrainingSession() {
+  if (m_pthread_) {
+    m_agent_.StopLearning();
+    m_pthread_->wait();
+  }
+}
+
+void TrainingSession::Start() {
+  // The agent stays in this thread, so StopLearning runs directly on
+  // disconnect; Progress is queued back here from the worker.
+  m_pthread_ = QThread::create([this]() {
+    Maze::InitRandom();
+    m_agent_.Train();
+  });
+  m_pthread_->setParent(this);
+  connect(m_pthread_, &QThread::finished, this, &TrainingSession::OnFinished);
+  m_pthread_->start();
+}
+
+void TrainingSession::OnProgress(int percent) {
+  if (!ClientConnected()) return;
+  QByteArray data;
+  JsonWriter<QByteArray> json(data);
+  json.BeginObject();
+  json.Key("percent");
+  json.Int(percent);
+  json.EndObject();
+  SendEvent("progress", data);
+}
+
+void TrainingSession::OnFinished() {
+  if (ClientConnected() && !m_agent_.IsLearning()) {
+    QByteArray data;
+    JsonWriter<QByteArray> json(data);
+    json.BeginObject();
+    json.Key("pass");
+    json.BeginArray();
+    for (const auto& p : m_agent_.FindPath(m_start_)) {
+      json.BeginArray();
+      json.Int(p.r);
+      json.Int(p.c);
+      json.EndArray();
+    }
+    json.EndArray();
+    json.EndObject();
+    SendEvent("path", data);
+    SendEvent("done", "{}");
+    m_pclient_->flush();
+    m_pclient_->disconnectFromHost();
+  }
+  deleteLater();
+}
+
+void TrainingSession::SendEvent(const char* event, const QByteArray& data) {
+  QByteArray message = "event: " + QByteArray(event) + "\ndata: " + data +
+                       "\n\n";
+  m_pclient_->write(message);
+  m_pclient_->flush();
+  emit BytesSent(message.size());
+}
+
+bool TrainingSession::ClientConnected() const {
+  return m_pclient_ && m_pclient_->state() == QAbstractSocket::ConnectedState;
+}
@@ -0,0 +1,46 @@
+#ifndef TRAINING_SESSION_H
+#define TRAINING_SESSION_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QThread>
+
+#include "../model/maze/maze.h"
+#include "../model/q_learning/q_learning.h"
+
+// One /train request: runs QLearning::Train on a worker thread and streams
+// its progress and the learned path to the client as server-sent events.
+// Training stops when the client disconnects; the session deletes itself
+// once the worker thread has finished.
+class TrainingSession : public QObject {
+  Q_OBJECT
+
+ public:
+  TrainingSession(const Maze& maze, Cell start, Cell goal, QTcpSocket* client,
+                  QObject* parent = nullptr);
+  ~TrainingSession();
+
+  void Start();
+
+ signals:
+  void BytesSent(qint64 bytes);
+
+ private slots:
+  void OnProgress(int percent);
+  void OnFinished();
+
+ private:
+  void SendEvent(const char* event, const QByteArray& data);
+  bool ClientConnected() const;
+
+  Maze m_maze_;
+  Cell m_start_;
+  Cell m_goal_;
+  QLearning m_agent_;
+  QThread* m_pthread_;
+  QPointer<QTcpSocket> m_pclient_;
+};
+
+#endif  // TRAINING_SESSION_H
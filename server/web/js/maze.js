@@ -12,6 +12,7 @@ let hWalls = [];
 let start = new Point(0, 0);
 let end = new Point(19, 29);
 let path = [];
+let mazeId = null;
 
 
 async function fetchMazeFromServer() {
@@ -24,6 +25,7 @@ async function fetchMazeFromServer() {
     throw new Error('Can not get maze from server');
   }
   const data = await response.json();
+  mazeId = data.id;
   vWalls = data.verticals.map(v => BigInt(v));
   hWalls = data.horizontals.map(h => BigInt(h));
 
@@ -38,19 +40,31 @@ async function fetchMazeFromServer() {
   drawPoint(ctx, end.row, end.col, cellWidth, cellHeight, size, 'red');
 }
 
-async function fetchPathFromServer() {
-  const response = await fetch('http://localhost:8080/pass', {
+function postPass(body) {
+  return fetch('http://localhost:8080/pass', {
     method: 'POST',
     headers: {'Content-Type': 'application/json'},
-    body: JSON.stringify({
+    body: JSON.stringify(body)
+  });
+}
+
+async function fetchPathFromServer() {
+  const points = {start: [start.row, start.col], end: [end.row, end.col]};
+  let response = null;
+  if (mazeId) {
+    response = await postPass({id: mazeId, ...points});
+  }
+  // The server forgets idle mazes, so fall back to sending the walls.
+  if (!response || !response.ok) {
+    mazeId = null;
+    response = await postPass({
       rows: maze.rows,
       cols: maze.cols,
-      start: [start.row, start.col],
-      end: [end.row, end.col],
+      ...points,
       verticals: vWalls.map(v => v.toString()),
       horizontals: hWalls.map(h => h.toString())
-    })
-  });
+    });
+  }
   if (!response.ok) {
     throw new Error('Cannot get path from server');
   }
@@ -265,6 +279,7 @@ function loadMaze(content) {
 
   vWalls = vWallsMatrix;
   hWalls = hWallsMatrix;
+  mazeId = null;
 
   start = new Point(0, 0);
   end = new Point(rows - 1, cols - 1);
@@ -0,0 +1,131 @@
+// Measures bytes and heap allocations per serialized server response.
+// Build and run with `make bench` from tests/.
+//
+// Bodies and headers are written by ResponseWriter, the same code TcpServer
+// uses. When Qt6Core is installed the bench also writes into QByteArray like
+// the server does, and runs the QJsonDocument serialization that
+// ResponseWriter replaced as a baseline.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "../../model/maze/maze.h"
+#include "../../server/response_writer.h"
+
+#ifdef HAVE_QT
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#endif
+
+namespace {
+std::size_t g_allocs = 0;
+}
+
+void* operator new(std::size_t size) {
+  ++g_allocs;
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr int kIterations = 20000;
+
+// Runs write(body) and then the response header, as SendHttpResponse does.
+template <typename Buffer, typename Fn>
+void Run(const char* name, Fn write) {
+  std::size_t bytes = 0;
+  std::size_t allocs_before = g_allocs;
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    Buffer body;
+    write(body);
+    Buffer header;
+    ResponseWriter::WriteHeader(header, 200, "OK", "application/json",
+                                body.size());
+    bytes = header.size() + body.size();
+  }
+  auto end = std::chrono::steady_clock::now();
+  double allocs = double(g_allocs - allocs_before) / kIterations;
+  double ns =
+      std::chrono::duration<double, std::nano>(end - begin).count() /
+      kIterations;
+  std::printf("%-14s %8zu bytes/response %6.2f allocs/response %10.0f ns\n",
+              name, bytes, allocs, ns);
+}
+
+#ifdef HAVE_QT
+// The serialization used before ResponseWriter: a QJson tree rendered with
+// indented toJson().
+QByteArray QtMaze(const Maze& maze, uint64_t id) {
+  auto verticals = maze.GetVerticals();
+  auto horizontals = maze.GetHorizontals();
+  QJsonArray verticals_array;
+  QJsonArray horizontals_array;
+  for (int i = 0; i < maze.GetRows(); ++i) {
+    verticals_array.append(QString::number(verticals[i]));
+    horizontals_array.append(QString::number(horizontals[i]));
+  }
+  QJsonObject object;
+  object["id"] = QString::number(id, 16);
+  object["verticals"] = verticals_array;
+  object["horizontals"] = horizontals_array;
+  return QJsonDocument(object).toJson();
+}
+
+QByteArray QtPass(const std::vector<Cell>& pass) {
+  QJsonArray pass_array;
+  for (const auto& p : pass) {
+    QJsonArray coord;
+    coord.append(p.r);
+    coord.append(p.c);
+    pass_array.append(coord);
+  }
+  QJsonObject object;
+  object["pass"] = pass_array;
+  return QJsonDocument(object).toJson();
+}
+#endif
+
+}  // namespace
+
+int main() {
+  Maze::InitRandom();
+  Maze maze(kMaxSize, kMaxSize);
+  maze.GenerateMaze();
+  const uint64_t id = 0x3f2a9c4d5e6b7a81;
+  std::vector<Cell> pass =
+      maze.SolveMaze({0, 0}, {kMaxSize - 1, kMaxSize - 1});
+
+  Run<std::string>("maze", [&](std::string& out) {
+    ResponseWriter::WriteMaze(out, maze, id);
+  });
+  Run<std::string>("pass", [&](std::string& out) {
+    ResponseWriter::WritePass(out, pass);
+  });
+#ifdef HAVE_QT
+  Run<QByteArray>("maze/qbytes", [&](QByteArray& out) {
+    ResponseWriter::WriteMaze(out, maze, id);
+  });
+  Run<QByteArray>("pass/qbytes", [&](QByteArray& out) {
+    ResponseWriter::WritePass(out, pass);
+  });
+  Run<QByteArray>("maze/qjson", [&](QByteArray& out) {
+    out = QtMaze(maze, id);
+  });
+  Run<QByteArray>("pass/qjson", [&](QByteArray& out) {
+    out = QtPass(pass);
+  });
+#else
+  std::printf("Qt6Core not found: QByteArray and QJsonDocument runs skipped\n");
+#endif
+  return 0;
+}
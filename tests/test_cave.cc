@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <bit>
+#include <memory>
+#include <thread>
+
+#include "../model/maze/cave_regions.h"
 #include "../model/maze/maze.h"
 
 int CountAliveCells(const Maze *cave) {
@@ -13,6 +18,33 @@ int CountAliveCells(const Maze *cave) {
   return count;
 }
 
+// Shortest path length through dead cells by plain BFS, 0 if unreachable.
+size_t CaveDistance(const Maze &cave, Cell start, Cell end) {
+  auto cells = cave.GetVerticals();
+  auto open = [&](Cell c) {
+    return c.r >= 0 && c.c >= 0 && c.r < cave.GetRows() &&
+           c.c < cave.GetCols() && !Maze::GetBit(cells[c.r], c.c);
+  };
+  if (!open(start) || !open(end)) return 0;
+  std::vector<int> dist(kMaxSize * kMaxSize, -1);
+  std::queue<Cell> queue;
+  queue.push(start);
+  dist[start.r * kMaxSize + start.c] = 0;
+  while (!queue.empty()) {
+    Cell cell = queue.front();
+    queue.pop();
+    if (cell == end) return dist[cell.r * kMaxSize + cell.c] + 1;
+    for (Cell step : {Cell{-1, 0}, Cell{1, 0}, Cell{0, 1}, Cell{0, -1}}) {
+      Cell next = cell + step;
+      if (open(next) && dist[next.r * kMaxSize + next.c] < 0) {
+        dist[next.r * kMaxSize + next.c] = dist[cell.r * kMaxSize + cell.c] + 1;
+        queue.push(next);
+      }
+    }
+  }
+  return 0;
+}
+
 TEST(CaveTest, GenerateCaveBasic) {
   Maze::InitRandom();
   Maze cave(10, 10);
@@ -100,3 +132,354 @@ TEST(CaveTest, SetRowsCols) {
   EXPECT_FALSE(cave.SetRowsCols(kMaxSize + 1, 10));
   EXPECT_FALSE(cave.SetRowsCols(10, kMaxSize + 1));
 }
+
+TEST(CaveTest, SolveCaveStepsMatchesSingleSteps) {
+  Maze::InitRandom();
+  Maze batched(20, 20);
+  batched.GenerateCave(0.45);
+  Maze single = batched;
+
+  bool stable = false;
+  int done = batched.SolveCaveSteps(4, 3, 3, stable);
+  if (!stable) {
+    EXPECT_EQ(done, 3);
+  }
+  bool single_stable = false;
+  for (int i = 0; i < done; ++i) single_stable = single.SolveCave(4, 3);
+  EXPECT_EQ(stable, single_stable);
+  EXPECT_EQ(batched.GetVerticals(), single.GetVerticals());
+}
+
+TEST(CaveTest, SolveCaveStepsStopsWhenStable) {
+  Maze cave(5, 5);
+  cave.GenerateCave(1.0);
+
+  bool stable = false;
+  EXPECT_EQ(cave.SolveCaveSteps(4, 3, 100, stable), 1);
+  EXPECT_TRUE(stable);
+  EXPECT_EQ(CountAliveCells(&cave), 25);
+}
+
+TEST(CaveTest, SolveCaveReportsChangedRows) {
+  Maze::InitRandom();
+  Maze cave(20, 20);
+  cave.GenerateCave(0.45);
+
+  auto before = cave.GetVerticals();
+  uint64_t changed = 0;
+  bool stable = cave.SolveCave(4, 3, changed);
+  auto after = cave.GetVerticals();
+  for (int i = 0; i < cave.GetRows(); ++i)
+    EXPECT_EQ(Maze::GetBit(changed, i), before[i] != after[i]);
+  EXPECT_EQ(changed >> cave.GetRows(), 0u);
+  EXPECT_EQ(stable, changed == 0);
+
+  Maze full(5, 5);
+  full.GenerateCave(1.0);
+  EXPECT_TRUE(full.SolveCave(4, 3, changed));
+  EXPECT_EQ(changed, 0u);
+}
+
+TEST(CaveTest, PathSearchesMatchBfsLength) {
+  Maze::InitRandom();
+  for (double chance : {0.2, 0.35, 0.45}) {
+    Maze cave(kMaxSize, kMaxSize);
+    cave.GenerateCave(chance);
+    bool stable = false;
+    cave.SolveCaveSteps(4, 3, 2, stable);
+    auto cells = cave.GetVerticals();
+    for (int i = 0; i < 80; ++i) {
+      Cell start{(i * 7) % kMaxSize, (i * 13) % kMaxSize};
+      Cell end{(i * 31 + 5) % kMaxSize, (i * 17 + 9) % kMaxSize};
+      size_t expected = CaveDistance(cave, start, end);
+      for (SearchMode mode : {SearchMode::kAStar, SearchMode::kJumpPoint}) {
+        auto pass = cave.SolveCavePath(end, start, mode);
+        ASSERT_EQ(pass.size(), expected);
+        if (pass.empty()) continue;
+        EXPECT_EQ(pass.front(), end);
+        EXPECT_EQ(pass.back(), start);
+        for (size_t k = 0; k < pass.size(); ++k) {
+          EXPECT_FALSE(Maze::GetBit(cells[pass[k].r], pass[k].c));
+          if (k > 0) {
+            EXPECT_EQ(std::abs(pass[k].r - pass[k - 1].r) +
+                          std::abs(pass[k].c - pass[k - 1].c),
+                      1);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(CaveTest, PathSearchRejectsSolidEnds) {
+  Maze cave(5, 5);
+  cave.GenerateCave(0.0);
+  std::array<uint64_t, kMaxSize> cells{};
+  cells[2] = 0b01111;  // wall with a gap in the last column
+  cells[4] = 0b00001;
+  cave.SetVerticals(cells);
+
+  EXPECT_TRUE(cave.SolveCavePath({4, 0}, {0, 0}).empty());
+  auto pass = cave.SolveCavePath({3, 0}, {0, 0});
+  EXPECT_EQ(pass.size(), 12u);
+  EXPECT_EQ(cave.SolveCavePath({3, 0}, {0, 0}, SearchMode::kAStar).size(),
+            12u);
+  EXPECT_EQ(cave.SolveCavePath({0, 0}, {0, 0}).size(), 1u);
+}
+
+TEST(CaveTest, RegionsMatchBfsReachability) {
+  Maze::InitRandom();
+  for (double chance : {0.3, 0.45, 0.6}) {
+    Maze cave(37, kMaxSize);
+    cave.GenerateCave(chance);
+    const std::shared_ptr<const CaveRegions> labelled = cave.Regions();
+    const CaveRegions &regions = *labelled;
+
+    int open = 0;
+    for (int r = 0; r < cave.GetRows(); ++r)
+      for (int c = 0; c < cave.GetCols(); ++c)
+        open += regions.Region({r, c}) != CaveRegions::kSolid;
+    EXPECT_EQ(open, cave.GetRows() * cave.GetCols() - CountAliveCells(&cave));
+    int total = 0;
+    for (int i = 0; i < regions.Count(); ++i) total += regions.Size(i);
+    EXPECT_EQ(total, open);
+
+    for (int i = 0; i < 200; ++i) {
+      Cell a{(i * 7) % 37, (i * 13) % kMaxSize};
+      Cell b{(i * 29 + 3) % 37, (i * 17 + 11) % kMaxSize};
+      EXPECT_EQ(regions.Connected(a, b), CaveDistance(cave, a, b) > 0);
+    }
+  }
+}
+
+TEST(CaveTest, RegionsAreCachedUntilTheCaveChanges) {
+  Maze::InitRandom();
+  Maze cave(20, 20);
+  cave.GenerateCave(0.45);
+  std::shared_ptr<const CaveRegions> first = cave.Regions();
+  EXPECT_EQ(cave.Regions(), first);
+
+  Maze copy = cave;
+  EXPECT_EQ(copy.Regions(), first);
+
+  uint64_t changed = 0;
+  cave.SolveCave(4, 3, changed);
+  EXPECT_EQ(cave.Regions()->Matches(copy), changed == 0);
+  EXPECT_TRUE(cave.Regions()->Matches(cave));
+  EXPECT_EQ(copy.Regions(), first);
+}
+
+TEST(CaveTest, RegionsOutliveARelabel) {
+  Maze cave(5, 7);
+  std::array<uint64_t, kMaxSize> cells{};
+  for (int r = 0; r < 5; ++r) cells[r] = 0b0011100;
+  cave.SetVerticals(cells);
+  std::shared_ptr<const CaveRegions> before = cave.Regions();
+
+  cave.ConnectCave(1);
+  EXPECT_EQ(cave.Regions()->Count(), 1);
+  EXPECT_EQ(before->Count(), 2);
+  EXPECT_FALSE(before->Connected({0, 0}, {0, 6}));
+}
+
+TEST(CaveTest, RegionsAreSharedAcrossThreads) {
+  Maze::InitRandom();
+  Maze cave(kMaxSize, kMaxSize);
+  cave.GenerateCave(0.45);
+  const Maze& shared = cave;
+  std::vector<std::shared_ptr<const CaveRegions>> seen(4);
+  std::vector<std::thread> threads;
+  for (auto& regions : seen)
+    threads.emplace_back([&shared, &regions] { regions = shared.Regions(); });
+  for (auto& thread : threads) thread.join();
+  for (const auto& regions : seen) EXPECT_EQ(regions, seen[0]);
+}
+
+TEST(CaveTest, ConnectCaveLeavesOneRegion) {
+  Maze::InitRandom();
+  for (double chance : {0.4, 0.5, 0.6}) {
+    Maze cave(kMaxSize, 40);
+    cave.GenerateCave(chance);
+    bool stable = false;
+    cave.SolveCaveSteps(4, 3, 5, stable);
+    const std::shared_ptr<const CaveRegions> before = cave.Regions();
+    int largest = 0;
+    for (int i = 0; i < before->Count(); ++i)
+      largest = std::max(largest, before->Size(i));
+    Maze original = cave;
+
+    int carved = cave.ConnectCave(10);
+    const std::shared_ptr<const CaveRegions> after = cave.Regions();
+    if (largest == 0) {
+      EXPECT_EQ(after->Count(), 0);
+      continue;
+    }
+    ASSERT_EQ(after->Count(), 1);
+    EXPECT_GE(after->Size(0), largest);
+    EXPECT_GE(carved, 0);
+    // Carving only opens cells; filling only closes cells of small regions.
+    auto old_cells = original.GetVerticals();
+    auto new_cells = cave.GetVerticals();
+    int opened = 0;
+    for (int r = 0; r < cave.GetRows(); ++r) {
+      uint64_t gone = old_cells[r] & ~new_cells[r];
+      opened += std::popcount(gone);
+      uint64_t filled = new_cells[r] & ~old_cells[r];
+      for (int c = 0; c < cave.GetCols(); ++c) {
+        if (Maze::GetBit(filled, c)) {
+          EXPECT_LT(before->Size(before->Region({r, c})), 10);
+        }
+      }
+    }
+    EXPECT_EQ(opened, carved);
+  }
+}
+
+TEST(CaveTest, ConnectCaveCarvesShortestTunnel) {
+  Maze cave(5, 7);
+  std::array<uint64_t, kMaxSize> cells{};
+  for (int r = 0; r < 5; ++r) cells[r] = 0b0011100;  // 3-wide wall
+  cave.SetVerticals(cells);
+
+  EXPECT_EQ(cave.Regions()->Count(), 2);
+  EXPECT_EQ(cave.ConnectCave(1), 3);
+  EXPECT_EQ(cave.Regions()->Count(), 1);
+  EXPECT_EQ(CountAliveCells(&cave), 12);
+
+  cave.SetVerticals(cells);
+  EXPECT_EQ(cave.ConnectCave(20), 0);  // both small: keep the largest only
+  EXPECT_EQ(cave.Regions()->Count(), 1);
+}
+
+TEST(CaveTest, RunCaveToStableMatchesSolveCave) {
+  Maze::InitRandom();
+  for (int birth = 0; birth <= 8; ++birth) {
+    for (int death = 0; death <= 8; ++death) {
+      Maze fast(7 + birth, 50 - death);
+      fast.GenerateCave(0.45);
+      Maze slow = fast;
+      std::vector<std::array<uint64_t, kMaxSize>> states{slow.GetVerticals()};
+
+      CaveRun run = fast.RunCaveToStable(birth, death, 200);
+      for (int i = 0; i < run.steps; ++i) {
+        slow.SolveCave(birth, death);
+        states.push_back(slow.GetVerticals());
+      }
+      EXPECT_EQ(fast.GetVerticals(), slow.GetVerticals());
+      ASSERT_GT(run.period, 0);
+      EXPECT_EQ(states[run.steps], states[run.steps - run.period]);
+      for (int i = 0; i < run.steps; ++i)
+        for (int j = 0; j < i; ++j) EXPECT_NE(states[i], states[j]);
+    }
+  }
+}
+
+TEST(CaveTest, RunCaveToStableDetectsCycles) {
+  Maze cave(4, 4);
+  std::array<uint64_t, kMaxSize> cells{};
+  cells[1] = cells[2] = 0b0110;
+  cave.SetVerticals(cells);
+
+  // The block dies and the border is born, then the other way round.
+  CaveRun run = cave.RunCaveToStable(0, 8, 100);
+  EXPECT_EQ(run.steps, 2);
+  EXPECT_EQ(run.period, 2);
+  EXPECT_EQ(cave.GetVerticals(), cells);
+
+  Maze full(5, 5);
+  full.GenerateCave(1.0);
+  run = full.RunCaveToStable(4, 3, 100);
+  EXPECT_EQ(run.steps, 1);
+  EXPECT_EQ(run.period, 1);
+
+  cave.SetVerticals(cells);
+  run = cave.RunCaveToStable(0, 8, 1);
+  EXPECT_EQ(run.steps, 1);
+  EXPECT_EQ(run.period, 0);
+
+  // Bits past the last column are not part of the cave.
+  auto stray = cells;
+  stray[0] |= uint64_t(1) << 20;
+  stray[2] |= uint64_t(1) << 4;
+  cave.SetVerticals(stray);
+  run = cave.RunCaveToStable(0, 8, 100);
+  EXPECT_EQ(run.steps, 2);
+  EXPECT_EQ(run.period, 2);
+  EXPECT_EQ(cave.GetVerticals(), cells);
+}
+
+TEST(CaveTest, RunCaveToStableDetectsRadiusCycles) {
+  Maze cave(4, 4);
+  std::array<uint64_t, kMaxSize> cells{};
+  cells[1] = cells[2] = 0b0110;
+  cave.SetVerticals(cells);
+
+  // As with radius 1, the block and the border take turns.
+  CaveRun run = cave.RunCaveToStable(0, 24, 100, 2);
+  EXPECT_EQ(run.steps, 2);
+  EXPECT_EQ(run.period, 2);
+  EXPECT_EQ(cave.GetVerticals(), cells);
+
+  Maze::InitRandom();
+  for (int radius : {2, 3}) {
+    const int birth = 2 * radius * (radius + 1);
+    Maze fast(17, 29);
+    fast.GenerateCave(0.45);
+    Maze slow = fast;
+    run = fast.RunCaveToStable(birth, birth - radius, 200, radius);
+    for (int i = 0; i < run.steps; ++i)
+      slow.SolveCaveRadius(birth, birth - radius, radius);
+    EXPECT_EQ(fast.GetVerticals(), slow.GetVerticals());
+    EXPECT_GT(run.period, 0);
+  }
+  EXPECT_THROW(cave.RunCaveToStable(4, 3, 10, 0), std::invalid_argument);
+}
+
+TEST(CaveTest, SolveCaveRadiusOneMatchesSolveCave) {
+  Maze::InitRandom();
+  for (int birth = 0; birth <= 8; ++birth) {
+    for (int death = 0; death <= 8; ++death) {
+      Maze summed(10 + birth, 41 + death);
+      summed.GenerateCave(0.45);
+      Maze moore = summed;
+      for (int step = 0; step < 3; ++step) {
+        uint64_t summed_changed = 0;
+        uint64_t moore_changed = 0;
+        EXPECT_EQ(summed.SolveCaveRadius(birth, death, 1, summed_changed),
+                  moore.SolveCave(birth, death, moore_changed));
+        EXPECT_EQ(summed_changed, moore_changed);
+        EXPECT_EQ(summed.GetVerticals(), moore.GetVerticals());
+      }
+    }
+  }
+}
+
+TEST(CaveTest, SolveCaveRadiusCountsTheWholeSquare) {
+  Maze::InitRandom();
+  for (int radius : {2, 3, 7}) {
+    Maze cave(23, 31);
+    cave.GenerateCave(0.45);
+    auto cells = cave.GetVerticals();
+    const int birth = 2 * radius * (radius + 1);  // half the neighbours
+    const int death = birth - radius;
+    cave.SolveCaveRadius(birth, death, radius);
+    auto next = cave.GetVerticals();
+    for (int i = 0; i < cave.GetRows(); ++i) {
+      for (int j = 0; j < cave.GetCols(); ++j) {
+        int sum = -Maze::GetBit(cells[i], j);
+        for (int r = i - radius; r <= i + radius; ++r) {
+          for (int c = j - radius; c <= j + radius; ++c) {
+            bool inside = r >= 0 && c >= 0 && r < cave.GetRows() &&
+                          c < cave.GetCols();
+            sum += inside ? Maze::GetBit(cells[r], c) : 1;
+          }
+        }
+        bool alive =
+            Maze::GetBit(cells[i], j) ? sum >= death : sum > birth;
+        EXPECT_EQ(Maze::GetBit(next[i], j), alive) << i << "," << j;
+      }
+    }
+  }
+  Maze cave(5, 5);
+  EXPECT_THROW(cave.SolveCaveRadius(4, 3, 0), std::invalid_argument);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../server/json_writer.h"
+#include "../server/response_writer.h"
+
+TEST(JsonWriterTest, NestedArrays) {
+  std::string out;
+  JsonWriter<std::string> json(out);
+  json.BeginObject();
+  json.Key("pass");
+  json.BeginArray();
+  json.BeginArray();
+  json.Int(0);
+  json.Int(1);
+  json.EndArray();
+  json.BeginArray();
+  json.Int(-2);
+  json.Int(3);
+  json.EndArray();
+  json.EndArray();
+  json.EndObject();
+  EXPECT_EQ(out, R"({"pass":[[0,1],[-2,3]]})");
+}
+
+TEST(JsonWriterTest, KeysAndScalars) {
+  std::string out;
+  JsonWriter<std::string> json(out);
+  json.BeginObject();
+  json.Key("walls");
+  json.BeginArray();
+  json.UIntString(18446744073709551615ULL);
+  json.UIntString(0);
+  json.EndArray();
+  json.Key("ok");
+  json.Bool(true);
+  json.Key("n");
+  json.UInt(42);
+  json.EndObject();
+  EXPECT_EQ(out, R"({"walls":["18446744073709551615","0"],"ok":true,"n":42})");
+}
+
+TEST(JsonWriterTest, EscapesStrings) {
+  std::string out;
+  JsonWriter<std::string> json(out);
+  json.BeginArray();
+  json.String("a\"b\\c\n");
+  json.String("");
+  json.EndArray();
+  EXPECT_EQ(out, R"(["a\"b\\c\u000a",""])");
+}
+
+TEST(ResponseWriterTest, WritesPassAndHeader) {
+  std::string body;
+  ResponseWriter::WritePass(body, {{0, 1}, {2, 3}});
+  EXPECT_EQ(body, R"({"pass":[[0,1],[2,3]]})");
+
+  std::string header;
+  ResponseWriter::WriteHeader(header, 404, "Not Found", "text/plain", 14,
+                              "Retry-After: 1\r\n");
+  EXPECT_EQ(header,
+            "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n"
+            "Content-Length: 14\r\nRetry-After: 1\r\n"
+            "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n");
+}
+
+TEST(ResponseWriterTest, WritesMazeWithHexId) {
+  Maze maze(2, 2);
+  std::array<uint64_t, kMaxSize> walls{};
+  walls[0] = 2;
+  maze.SetVerticals(walls);
+  std::string body;
+  ResponseWriter::WriteMaze(body, maze, 0xab);
+  EXPECT_EQ(body,
+            R"({"id":"ab","verticals":["2","0"],"horizontals":["0","0"]})");
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "../model/maze/maze.h"
+#include "../model/maze/solver_workspace.h"
 
 TEST(MazeTest, DefaultMazeGeneration) {
   Maze maze(50, 50);
@@ -38,6 +41,153 @@ TEST(MazeTest, BfsSingleRow) {
   EXPECT_EQ(path.back(), start);
 }
 
+TEST(MazeTest, SolveIntoBufferReusesIt) {
+  Maze maze(12, 12);
+  maze.GenerateMaze();
+
+  std::vector<Cell> pass;
+  ASSERT_TRUE(maze.SolveMaze({11, 11}, {0, 0}, pass));
+  EXPECT_EQ(pass, maze.SolveMaze({11, 11}, {0, 0}));
+
+  pass.reserve(12 * 12);
+  const Cell* data = pass.data();
+  ASSERT_TRUE(maze.SolveMaze({5, 7}, {0, 0}, pass));
+  EXPECT_EQ(pass.data(), data);
+  EXPECT_EQ(pass, maze.SolveMaze({5, 7}, {0, 0}));
+}
+
+TEST(MazeTest, WorkspaceSolvesMatchDistances) {
+  SolverWorkspace workspace;
+  std::vector<Cell> pass;
+  for (int round = 0; round < 3; ++round) {
+    Maze maze(10 + round * 15, 40 - round * 10);
+    maze.GenerateMaze();
+    Cell start{round, 2 * round};
+    auto distances = maze.DistanceMatrix(start);
+    for (Cell end : distances.cells) {
+      ASSERT_TRUE(maze.SolveMaze(end, start, pass, workspace));
+      EXPECT_EQ(pass.size(), distances.Distance(end) + 1);
+      EXPECT_EQ(pass.front(), end);
+      EXPECT_EQ(pass.back(), start);
+    }
+  }
+}
+
+TEST(MazeTest, WorkspaceDirectionsArePacked) {
+  SolverWorkspace workspace;
+  workspace.Reset();
+  for (int i = 0; i < 8; ++i) workspace.Visit(i, i % 4);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(workspace.Visited(i));
+    EXPECT_EQ(workspace.Direction(i), i % 4);
+  }
+  EXPECT_FALSE(workspace.Visited(8));
+  workspace.Reset();
+  EXPECT_FALSE(workspace.Visited(0));
+}
+
+TEST(MazeTest, InitRandomSeedsEachThread) {
+  uint32_t draws[2] = {};
+  std::thread first([&draws] {
+    Maze::InitRandom();
+    draws[0] = Maze::_gen();
+  });
+  std::thread second([&draws] {
+    Maze::InitRandom();
+    draws[1] = Maze::_gen();
+  });
+  first.join();
+  second.join();
+  EXPECT_NE(draws[0], draws[1]);
+  EXPECT_NE(draws[0], std::mt19937()());
+}
+
+TEST(MazeTest, BidirectionalMatchesBfsLength) {
+  Maze::InitRandom();
+  for (auto [rows, cols] : {std::pair{1, 30}, {17, 23}, {50, 50}}) {
+    Maze maze(rows, cols);
+    maze.GenerateMaze();
+    for (int i = 0; i < 60; ++i) {
+      Cell start{(i * 7) % rows, (i * 13) % cols};
+      Cell end{(i * 11 + 3) % rows, (i * 5 + 1) % cols};
+      auto bfs = maze.SolveMaze(end, start);
+      auto both = maze.SolveMaze(end, start, SearchMode::kBidirectional);
+      ASSERT_EQ(both.size(), bfs.size());
+      EXPECT_EQ(both.front(), end);
+      EXPECT_EQ(both.back(), start);
+      for (size_t k = 1; k < both.size(); ++k)
+        EXPECT_EQ(std::abs(both[k].r - both[k - 1].r) +
+                      std::abs(both[k].c - both[k - 1].c),
+                  1);
+    }
+  }
+}
+
+TEST(MazeTest, BidirectionalIsShortestInOpenGrid) {
+  Maze maze(20, 20);
+  maze.SetVerticals({});
+  maze.SetHorizontals({});
+  for (int i = 0; i < 20; ++i) {
+    Cell start{i, (i * 3) % 20};
+    Cell end{19 - i, (i * 7) % 20};
+    auto both = maze.SolveMaze(end, start, SearchMode::kBidirectional);
+    EXPECT_EQ(both.size(), static_cast<size_t>(std::abs(end.r - start.r) +
+                                               std::abs(end.c - start.c) + 1));
+  }
+}
+
+TEST(MazeTest, BidirectionalReportsMissingPath) {
+  Maze maze(4, 4);
+  std::array<uint64_t, kMaxSize> walls{};
+  walls[1] = 0xF;  // row 1 cut off from row 2
+  maze.SetVerticals({});
+  maze.SetHorizontals(walls);
+
+  std::vector<Cell> pass{{0, 0}};
+  EXPECT_FALSE(maze.SolveMaze({3, 3}, {0, 0}, pass,
+                              SearchMode::kBidirectional));
+  EXPECT_TRUE(pass.empty());
+  EXPECT_TRUE(maze.SolveMaze({2, 2}, {2, 2}, pass,
+                             SearchMode::kBidirectional));
+  EXPECT_EQ(pass.size(), 1u);
+  EXPECT_TRUE(maze.SolveMaze({1, 3}, {0, 0}, pass,
+                             SearchMode::kBidirectional));
+  EXPECT_EQ(pass.size(), 5u);
+}
+
+TEST(MazeTest, JumpPointIsRejectedOnMazes) {
+  Maze maze(3, 3);
+  maze.GenerateMaze();
+  EXPECT_THROW(maze.SolveMaze({2, 2}, {0, 0}, SearchMode::kJumpPoint),
+               std::invalid_argument);
+}
+
+TEST(MazeTest, AStarMatchesBfsLengthWithLoops) {
+  Maze::InitRandom();
+  Maze maze(30, 40);
+  maze.GenerateMaze();
+  // Knock out walls so there are loops and several shortest paths.
+  auto verticals = maze.GetVerticals();
+  auto horizontals = maze.GetHorizontals();
+  for (int i = 0; i < 30; ++i) {
+    verticals[i] &= ~(0x0F0F0F0F0FULL << (i % 4));
+    horizontals[i] &= ~(0xF0F0F0F0F0ULL >> (i % 3));
+  }
+  maze.SetVerticals(verticals);
+  maze.SetHorizontals(horizontals);
+
+  for (int i = 0; i < 60; ++i) {
+    Cell start{(i * 7) % 30, (i * 13) % 40};
+    Cell end{(i * 11 + 3) % 30, (i * 17 + 1) % 40};
+    auto bfs = maze.SolveMaze(end, start);
+    auto astar = maze.SolveMaze(end, start, SearchMode::kAStar);
+    ASSERT_EQ(astar.size(), bfs.size());
+    ASSERT_FALSE(astar.empty());
+    EXPECT_EQ(astar.front(), end);
+    EXPECT_EQ(astar.back(), start);
+  }
+}
+
 TEST(MazeTest, DistanceMatrixBasic) {
   Maze maze(3, 3);
   maze.GenerateMaze();
@@ -45,17 +195,63 @@ TEST(MazeTest, DistanceMatrixBasic) {
   Cell start{1, 1};
   auto dist_matrix = maze.DistanceMatrix(start);
 
-  ASSERT_FALSE(dist_matrix.empty());
-  ASSERT_FALSE(dist_matrix[0].empty());
-  EXPECT_EQ(dist_matrix[0][0], start);
+  ASSERT_GT(dist_matrix.Levels(), 0u);
+  ASSERT_FALSE(dist_matrix.Level(0).empty());
+  EXPECT_EQ(dist_matrix.Level(0)[0], start);
 
   int total_cells = 0;
-  for (const auto& level : dist_matrix) {
-    total_cells += static_cast<int>(level.size());
+  for (size_t i = 0; i < dist_matrix.Levels(); ++i) {
+    EXPECT_FALSE(dist_matrix.Level(i).empty());
+    total_cells += static_cast<int>(dist_matrix.Level(i).size());
   }
   EXPECT_GE(total_cells, maze.GetRows() * maze.GetCols());
 }
 
+TEST(MazeTest, DistanceMatrixMatchesPathLength) {
+  Maze maze(15, 20);
+  maze.GenerateMaze();
+
+  Cell start{4, 7};
+  auto dist_matrix = maze.DistanceMatrix(start);
+  ASSERT_EQ(dist_matrix.cells.size(), 15u * 20u);
+  for (size_t i = 0; i < dist_matrix.Levels(); ++i) {
+    for (Cell cell : dist_matrix.Level(i)) {
+      EXPECT_EQ(dist_matrix.Distance(cell), i);
+      EXPECT_EQ(maze.SolveMaze(cell, start).size(), i + 1);
+    }
+  }
+  EXPECT_EQ(maze.DistanceMatrix({-1, 0}).Levels(), 0u);
+}
+
+TEST(MazeTest, BatchMatchesSingleSolve) {
+  Maze maze(20, 30);
+  maze.GenerateMaze();
+
+  std::vector<std::pair<Cell, Cell>> queries;
+  for (int i = 0; i < 40; ++i) {
+    queries.push_back({{i % 20, (i * 7) % 30}, {(i / 10) * 5, 29 - i % 10}});
+  }
+  queries.push_back({{3, 3}, {3, 3}});
+
+  for (unsigned threads : {1u, 4u}) {
+    auto passes = maze.SolveMazeBatch(queries, threads);
+    ASSERT_EQ(passes.size(), queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+      EXPECT_EQ(passes[i], maze.SolveMaze(queries[i].first, queries[i].second));
+    }
+  }
+}
+
+TEST(MazeTest, BatchSkipsInvalidPoints) {
+  Maze maze(5, 5);
+  maze.GenerateMaze();
+
+  auto passes = maze.SolveMazeBatch({{{0, 0}, {4, 4}}, {{-1, 0}, {4, 4}}});
+  ASSERT_EQ(passes.size(), 2u);
+  EXPECT_FALSE(passes[0].empty());
+  EXPECT_TRUE(passes[1].empty());
+}
+
 TEST(MazeCopyMoveTest, CopyConstructor) {
   Maze original(5, 7);
   original.GenerateMaze();
@@ -1,64 +1,69 @@
 #include "bonus_draw.h"
 
 BonusDrawWidget::BonusDrawWidget(QWidget* parent)
-    : QWidget(parent),
-      m_rows_(),
-      m_cols_(),
-      m_solution_({}),
-      m_current_step_() {
+    : QWidget(parent), m_solution_(), m_current_step_() {
   setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 }
 
+const std::array<QRgb, BonusDrawWidget::kPaletteSize>&
+BonusDrawWidget::Palette() {
+  static const std::array<QRgb, kPaletteSize> palette = [] {
+    std::array<QRgb, kPaletteSize> colors;
+    for (int i = 0; i < kPaletteSize; ++i) {
+      float ratio = i / (float)kPaletteSize;
+      QColor heat_color;
+      if (ratio < 0.5) {
+        heat_color.setRgbF(0, 2 * ratio, 1 - 2 * ratio);
+      } else {
+        heat_color.setRgbF(2 * (ratio - 0.5), 1 - 2 * (ratio - 0.5), 0);
+      }
+      heat_color.setAlphaF(0.5);
+      colors[i] = qPremultiply(heat_color.rgba());
+    }
+    return colors;
+  }();
+  return palette;
+}
+
 void BonusDrawWidget::paintEvent(QPaintEvent*) {
-  if (m_solution_.empty()) return;
+  if (m_solution_.Levels() == 0) return;
   QPainter painter(this);
 
-  int cell_width = width() / m_cols_;
-  int cell_height = height() / m_rows_;
-  int size = std::min(cell_width, cell_height) * 0.3;
-  float step = 1.0f / (float)m_solution_.size();
-  for (int i = 0; i < m_current_step_; ++i) {
-    float ratio = i * step;
-    QColor heat_color;
+  int rows = m_solution_.rows;
+  int cols = m_solution_.cols;
+  int cell_width = width() / cols;
+  int cell_height = height() / rows;
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+  painter.drawImage(QRect(0, 0, cols * cell_width, rows * cell_height),
+                    m_heat_);
+}
 
-    if (ratio < 0.5) {
-      heat_color.setRgbF(0, 2 * ratio, 1 - 2 * ratio);
-    } else {
-      heat_color.setRgbF(2 * (ratio - 0.5), 1 - 2 * (ratio - 0.5), 0);
-    }
-    heat_color.setAlphaF(0.5);
-    for (auto point : m_solution_[i]) {
-      DrawPoint(painter, point, cell_width, cell_height, size, heat_color);
-    }
+void BonusDrawWidget::PaintLevel(int level) {
+  QRgb color = Palette()[level * kPaletteSize / m_solution_.Levels()];
+  for (auto point : m_solution_.Level(level)) {
+    reinterpret_cast<QRgb*>(m_heat_.scanLine(point.r))[point.c] = color;
   }
 }
 
 void BonusDrawWidget::NextStep() {
-  if (m_current_step_ < (int)m_solution_.size()) {
+  if (m_current_step_ < (int)m_solution_.Levels()) {
+    PaintLevel(m_current_step_);
     ++m_current_step_;
     update();
-    if (m_current_step_ < (int)m_solution_.size())
+    if (m_current_step_ < (int)m_solution_.Levels())
       QTimer::singleShot(30, this, &BonusDrawWidget::NextStep);
   }
 }
 
-void BonusDrawWidget::DrawPoint(QPainter& painter, const Cell& point,
-                                int cell_width, int cell_height, int /*size*/,
-                                const QColor& color) {
-  int x = point.c * cell_width;
-  int y = point.r * cell_height;
-  painter.setPen(Qt::NoPen);
-  painter.setBrush(color);
-  painter.drawRect(x, y, cell_width, cell_height);
-}
-
-void BonusDrawWidget::SetSolution(
-    const std::vector<std::vector<Cell>>& solution, int rows, int cols) {
-  m_rows_ = rows;
-  m_cols_ = cols;
-  m_solution_ = solution;
+void BonusDrawWidget::SetSolution(DistanceMap&& solution) {
+  m_solution_ = std::move(solution);
   m_current_step_ = 0;
+  int rows = m_solution_.rows;
+  int cols = m_solution_.cols;
+  if (m_heat_.width() != cols || m_heat_.height() != rows)
+    m_heat_ = QImage(cols, rows, QImage::Format_ARGB32_Premultiplied);
+  m_heat_.fill(Qt::transparent);
   update();
-  if (!m_solution_.empty())
+  if (m_solution_.Levels() != 0)
     QTimer::singleShot(25, this, &BonusDrawWidget::NextStep);
-}
\ No newline at end of file
+}
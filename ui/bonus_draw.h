@@ -1,9 +1,11 @@
 #ifndef DRAW_BONUS_H_
 #define DRAW_BONUS_H_
 
+#include <QImage>
 #include <QPainter>
 #include <QTimer>
 #include <QWidget>
+#include <array>
 
 #include "../model/maze/maze.h"
 
@@ -11,8 +13,7 @@ class BonusDrawWidget : public QWidget {
   Q_OBJECT
  public:
   explicit BonusDrawWidget(QWidget* parent = nullptr);
-  void SetSolution(const std::vector<std::vector<Cell>>& solution, int rows,
-                   int cols);
+  void SetSolution(DistanceMap&& solution);
 
  protected:
   void paintEvent(QPaintEvent*) override;
@@ -21,12 +22,12 @@ class BonusDrawWidget : public QWidget {
   void NextStep();
 
  private:
-  void DrawPoint(QPainter& painter, const Cell& point, int cell_width,
-                 int cell_height, int size, const QColor& color);
-  int m_rows_;
-  int m_cols_;
-  std::vector<std::vector<Cell>> m_solution_;
+  static constexpr int kPaletteSize = 256;
+  static const std::array<QRgb, kPaletteSize>& Palette();
+  void PaintLevel(int level);
+  DistanceMap m_solution_;
   int m_current_step_;
+  QImage m_heat_;  // one premultiplied pixel per cell, transparent if unseen
 };
 
-#endif  // DRAW_BONUS_H_
\ No newline at end of file
+#endif  // DRAW_BONUS_H_
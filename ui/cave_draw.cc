@@ -1,34 +1,72 @@
 #include "cave_draw.h"
 
+#include <QPaintEvent>
+#include <QtEndian>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
 CaveDrawWidget::CaveDrawWidget(Maze* cave, QWidget* parent)
     : QWidget(parent), m_pcave_(cave) {
   setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 }
 
-void CaveDrawWidget::paintEvent(QPaintEvent*) {
-  if (!m_pcave_) return;
-  QPainter painter(this);
-
-  int rows = m_pcave_->GetRows();
-  int cols = m_pcave_->GetCols();
-
-  int cell_width = width() / cols;
-  int cell_height = height() / rows;
+QSize CaveDrawWidget::CellSize() const {
+  int cell_width = width() / m_pcave_->GetCols();
+  int cell_height = height() / m_pcave_->GetRows();
 
   if (cell_width < 1) cell_width = 1;
   if (cell_height < 1) cell_height = 1;
+  return QSize(cell_width, cell_height);
+}
+
+void CaveDrawWidget::UpdateRows(uint64_t changed) {
+  if (!m_pcave_) return;
+  QSize cell = CellSize();
+  int span = m_pcave_->GetCols() * cell.width();
+  // One update per run of changed rows; Qt merges them into the next paint.
+  for (int i = 0; changed >> i;) {
+    i += std::countr_zero(changed >> i);
+    int run = std::countr_one(changed >> i);
+    update(QRect(0, i * cell.height(), span, run * cell.height()));
+    i += run;
+  }
+}
 
-  painter.setBrush(QBrush(Qt::black));
-  painter.setPen(Qt::NoPen);
+void CaveDrawWidget::UpdateImage(int rows, int cols) {
+  if (m_image_.width() != cols || m_image_.height() != rows) {
+    // MonoLSB keeps column j in bit j of the little-endian row, the same
+    // order as the cave words, so rows are copied without shuffling bits.
+    m_image_ = QImage(cols, rows, QImage::Format_MonoLSB);
+    m_image_.setColorTable({qRgb(255, 255, 255), qRgb(0, 0, 0)});
+  }
   auto matrix = m_pcave_->GetVerticals();
-  painter.fillRect(rect(), Qt::white);
+  size_t bytes = std::min<size_t>(m_image_.bytesPerLine(), sizeof(uint64_t));
   for (int i = 0; i < rows; ++i) {
-    for (int j = 0; j < cols; ++j) {
-      if (m_pcave_->GetBit(matrix[i], j)) {
-        int x = j * cell_width;
-        int y = i * cell_height;
-        painter.fillRect(x, y, cell_width, cell_height, Qt::black);
-      }
-    }
+    uchar word[sizeof(uint64_t)];
+    qToLittleEndian<quint64>(matrix[i], word);
+    std::memcpy(m_image_.scanLine(i), word, bytes);
   }
 }
+
+void CaveDrawWidget::paintEvent(QPaintEvent* event) {
+  if (!m_pcave_) return;
+  QPainter painter(this);
+
+  int rows = m_pcave_->GetRows();
+  int cols = m_pcave_->GetCols();
+  QSize cell = CellSize();
+
+  UpdateImage(rows, cols);
+  QRect dirty = event->rect();
+  painter.fillRect(dirty, Qt::white);
+
+  // Only the rows touching the dirty rectangle are scaled and drawn.
+  int first = std::max(0, dirty.top() / cell.height());
+  int last = std::min(rows - 1, dirty.bottom() / cell.height());
+  if (first > last) return;
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+  painter.drawImage(QRect(0, first * cell.height(), cols * cell.width(),
+                          (last - first + 1) * cell.height()),
+                    m_image_, QRect(0, first, cols, last - first + 1));
+}
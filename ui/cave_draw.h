@@ -1,6 +1,7 @@
 #ifndef DRAW_CAVE_H_
 #define DRAW_CAVE_H_
 
+#include <QImage>
 #include <QPainter>
 #include <QWidget>
 
@@ -10,12 +11,17 @@ class CaveDrawWidget : public QWidget {
   Q_OBJECT
  public:
   explicit CaveDrawWidget(Maze* cave, QWidget* parent = nullptr);
+  void UpdateRows(uint64_t changed);
 
  protected:
-  void paintEvent(QPaintEvent*) override;
+  void paintEvent(QPaintEvent* event) override;
 
  private:
+  void UpdateImage(int rows, int cols);
+  QSize CellSize() const;
+
   Maze* m_pcave_;
+  QImage m_image_;  // one bit per cell, rows x cols
 };
 
-#endif  // DRAW_CAVE_H_
\ No newline at end of file
+#endif  // DRAW_CAVE_H_
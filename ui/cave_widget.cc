@@ -1,7 +1,11 @@
 #include "cave_widget.h"
 
-CaveWidget::CaveWidget(QWidget* parent)
-    : QWidget(parent), m_steps_(), m_current_step_() {
+CaveWidget::CaveWidget(QWidget* parent, bool use_gl)
+    : QWidget(parent),
+      m_steps_(),
+      m_current_step_(),
+      m_pcave_view_(),
+      m_pgl_view_() {
   Maze::InitRandom();
   m_pcave_ = new Maze(kMaxSize / 2, kMaxSize / 2);
   m_pcave_->GenerateCave(0.5);
@@ -9,8 +13,14 @@ CaveWidget::CaveWidget(QWidget* parent)
   QHBoxLayout* main_layout = new QHBoxLayout(this);
   main_layout->addWidget(CreateSideMenu(), 0);
 
-  m_pcave_view_ = new CaveDrawWidget(m_pcave_, this);
-  main_layout->addWidget(m_pcave_view_);
+  if (use_gl) {
+    m_pgl_view_ = new GlMazeView(GlMazeView::Mode::kCave, this);
+    m_pgl_view_->SetMaze(*m_pcave_);
+    main_layout->addWidget(m_pgl_view_);
+  } else {
+    m_pcave_view_ = new CaveDrawWidget(m_pcave_, this);
+    main_layout->addWidget(m_pcave_view_);
+  }
 
   main_layout->setContentsMargins(0, 0, 0, 0);
   main_layout->setSpacing(0);
@@ -67,7 +77,7 @@ QWidget* CaveWidget::CreateParamsMenu(QGroupBox* solve_box) {
   QVBoxLayout* birth_layout = new QVBoxLayout();
   QLabel* birth_label = new QLabel("Birth:", params);
   m_birth_ = new QSpinBox(params);
-  m_birth_->setRange(0, 7);
+  m_birth_->setRange(0, 8);
   m_birth_->setValue(4);
   birth_layout->addWidget(birth_label);
   birth_layout->addWidget(m_birth_);
@@ -75,13 +85,28 @@ QWidget* CaveWidget::CreateParamsMenu(QGroupBox* solve_box) {
   QVBoxLayout* death_layout = new QVBoxLayout();
   QLabel* death_label = new QLabel("Death:", params);
   m_death_ = new QSpinBox(params);
-  m_death_->setRange(0, 7);
+  m_death_->setRange(0, 8);
   m_death_->setValue(3);
   death_layout->addWidget(death_label);
   death_layout->addWidget(m_death_);
   birth_death_layout->addLayout(birth_layout);
   birth_death_layout->addLayout(death_layout);
   params_layout->addLayout(birth_death_layout);
+
+  // A radius r square holds (2r + 1)^2 - 1 neighbours; like the server,
+  // birth and death may go up to that count.
+  QHBoxLayout* radius_layout = new QHBoxLayout();
+  m_radius_ = new QSpinBox(params);
+  m_radius_->setRange(1, 3);
+  radius_layout->addWidget(new QLabel("Radius:", params));
+  radius_layout->addWidget(m_radius_);
+  params_layout->addLayout(radius_layout);
+  connect(m_radius_, QOverload<int>::of(&QSpinBox::valueChanged), this,
+          [this](int radius) {
+            int neighbours = (2 * radius + 1) * (2 * radius + 1) - 1;
+            m_birth_->setRange(0, neighbours);
+            m_death_->setRange(0, neighbours);
+          });
   QPushButton* solve_button = new QPushButton("Solve", params);
   params_layout->addWidget(solve_button);
   params_layout->setContentsMargins(0, 0, 0, 0);
@@ -174,14 +199,14 @@ QGroupBox* CaveWidget::CreateSizeMenu(QWidget* menu) {
             m_chance_ = chance_spinbox->value();
             m_pcave_->SetRowsCols(rows->value(), cols->value());
             m_pcave_->GenerateCave(m_chance_);
-            m_pcave_view_->update();
+            RedrawCave();
             emit SwitchStackedPage(0);
           });
 
   connect(this, &CaveWidget::CaveSizeChanged, menu, [this, rows, cols]() {
     rows->setValue(m_pcave_->GetRows());
     cols->setValue(m_pcave_->GetCols());
-    m_pcave_view_->update();
+    RedrawCave();
   });
   return size;
 }
@@ -205,7 +230,7 @@ QHBoxLayout* CaveWidget::CreateButtonsLayout() {
   connect(load_btn, &QPushButton::clicked, this, [this]() {
     if (MazeFileLoader::LoadMazeFromFile(this, m_pcave_, 'c')) {
       emit CaveSizeChanged();
-      m_pcave_view_->update();
+      RedrawCave();
     }
   });
   connect(save_btn, &QPushButton::clicked, this,
@@ -226,8 +251,10 @@ QWidget* CaveWidget::CreateManualTab(QWidget* parent) {
   manual_tab->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
   layout->setAlignment(Qt::AlignTop);
   connect(next_step_btn, &QPushButton::clicked, this, [this]() {
-    m_pcave_->SolveCave(m_birth_->value(), m_death_->value());
-    m_pcave_view_->update();
+    uint64_t changed;
+    m_pcave_->SolveCaveRadius(m_birth_->value(), m_death_->value(),
+                              m_radius_->value(), changed);
+    RedrawRows(changed);
   });
   return manual_tab;
 }
@@ -251,9 +278,11 @@ QWidget* CaveWidget::CreateAutoTab(QWidget* parent) {
   connect(interval_spinbox, QOverload<int>::of(&QSpinBox::valueChanged), timer,
           [timer](int val) { timer->setInterval(val); });
   connect(timer, &QTimer::timeout, this, [this, timer]() {
-    bool done = m_pcave_->SolveCave(m_birth_->value(), m_death_->value());
+    uint64_t changed;
+    bool done = m_pcave_->SolveCaveRadius(
+        m_birth_->value(), m_death_->value(), m_radius_->value(), changed);
     ++m_current_step_;
-    m_pcave_view_->update();
+    RedrawRows(changed);
     if (done || m_current_step_ > m_steps_) {
       timer->stop();
     }
@@ -268,6 +297,24 @@ QWidget* CaveWidget::CreateAutoTab(QWidget* parent) {
   return auto_tab;
 }
 
+// The GL view uploads the whole cave, which is a few hundred bytes; the
+// QPainter view repaints only the changed rows.
+void CaveWidget::RedrawCave() {
+  if (m_pgl_view_) {
+    m_pgl_view_->SetMaze(*m_pcave_);
+  } else {
+    m_pcave_view_->update();
+  }
+}
+
+void CaveWidget::RedrawRows(uint64_t changed) {
+  if (m_pgl_view_) {
+    if (changed) m_pgl_view_->SetMaze(*m_pcave_);
+  } else {
+    m_pcave_view_->UpdateRows(changed);
+  }
+}
+
 QWidget* CaveWidget::CreatePageSwitcher(QWidget* parent) {
   QToolBox* tool_box = new QToolBox(parent);
   tool_box->addItem(CreateManualTab(tool_box), "Manual");
@@ -15,13 +15,14 @@
 
 #include "../model/maze/maze.h"
 #include "cave_draw.h"
+#include "gl_maze_view.h"
 #include "loader.h"
 #include "maze_style.h"
 
 class CaveWidget : public QWidget {
   Q_OBJECT
  public:
-  explicit CaveWidget(QWidget* parent = nullptr);
+  explicit CaveWidget(QWidget* parent = nullptr, bool use_gl = false);
 
  signals:
   void BackRequested();
@@ -36,7 +37,9 @@ class CaveWidget : public QWidget {
   int m_current_step_;
   QSpinBox* m_birth_;
   QSpinBox* m_death_;
+  QSpinBox* m_radius_;
   CaveDrawWidget* m_pcave_view_;
+  GlMazeView* m_pgl_view_;  // replaces m_pcave_view_ when set
 
   QWidget* CreateSideMenu();
   QGroupBox* CreateSizeMenu(QWidget* menu);
@@ -47,6 +50,8 @@ class CaveWidget : public QWidget {
   QWidget* CreateManualTab(QWidget* parent);
   QWidget* CreateAutoTab(QWidget* parent);
   QWidget* CreatePageSwitcher(QWidget* parent);
+  void RedrawCave();
+  void RedrawRows(uint64_t changed);
 };
 
 #endif
@@ -0,0 +1,240 @@
+#include "gl_maze_view.h"
+
+#include <QSurfaceFormat>
+#include <algorithm>
+
+namespace {
+const char* kVertexShader = R"(#version 330 core
+void main() {
+  vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+const char* kFragmentShader = R"(#version 330 core
+uniform usampler2D u_words;
+uniform usampler2D u_cells;
+uniform ivec2 u_size;
+uniform vec2 u_cell_px;
+uniform float u_height_px;
+uniform float u_wall_px;
+uniform int u_mode;
+uniform int u_path_length;
+uniform int u_heat_levels;
+uniform int u_visible;
+out vec4 frag_color;
+
+bool Bit(int word, int row, int bit) {
+  uvec2 w = texelFetch(u_words, ivec2(word, row), 0).rg;
+  uint half_word = bit < 32 ? w.x : w.y;
+  return ((half_word >> uint(bit & 31)) & 1u) != 0u;
+}
+
+vec3 Heat(float ratio) {
+  return ratio < 0.5 ? vec3(0.0, 2.0 * ratio, 1.0 - 2.0 * ratio)
+                     : vec3(2.0 * ratio - 1.0, 2.0 - 2.0 * ratio, 0.0);
+}
+
+void main() {
+  vec2 pixel = vec2(gl_FragCoord.x, u_height_px - gl_FragCoord.y);
+  ivec2 cell = ivec2(floor(pixel / u_cell_px));
+  if (cell.x >= u_size.x || cell.y >= u_size.y) discard;
+  vec2 local = pixel - vec2(cell) * u_cell_px;
+
+  if (u_mode == 1) {
+    frag_color = Bit(0, cell.y, cell.x) ? vec4(0.0, 0.0, 0.0, 1.0)
+                                        : vec4(1.0);
+    return;
+  }
+
+  vec3 color = vec3(1.0);
+  uvec2 info = texelFetch(u_cells, cell, 0).rg;
+  int level = int(info.g) - 1;
+  if (level >= 0 && level < u_visible && u_heat_levels > 0)
+    color = mix(color, Heat(float(level) / float(u_heat_levels)), 0.5);
+
+  int index = int(info.r);
+  bool endpoint = index == 1 || index == u_path_length;
+  if (index > 0 && (endpoint || index <= u_visible) &&
+      length(local - 0.5 * u_cell_px) < 0.2 * min(u_cell_px.x, u_cell_px.y))
+    color = index == 1 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+
+  bool wall =
+      (local.x >= u_cell_px.x - u_wall_px && cell.x < u_size.x - 1 &&
+       Bit(0, cell.y, cell.x)) ||
+      (local.x < u_wall_px && cell.x > 0 && Bit(0, cell.y, cell.x - 1)) ||
+      (local.y >= u_cell_px.y - u_wall_px && cell.y < u_size.y - 1 &&
+       Bit(1, cell.y, cell.x)) ||
+      (local.y < u_wall_px && cell.y > 0 && Bit(1, cell.y - 1, cell.x));
+  frag_color = vec4(wall ? vec3(0.0) : color, 1.0);
+}
+)";
+}  // namespace
+
+GlMazeView::GlMazeView(Mode mode, QWidget* parent)
+    : QOpenGLWidget(parent),
+      m_mode_(mode),
+      m_rows_(0),
+      m_cols_(0),
+      m_words_(),
+      m_path_length_(0),
+      m_heat_levels_(0),
+      m_visible_(0),
+      m_steps_(0),
+      m_dirty_(true),
+      m_words_texture_(0),
+      m_cells_texture_(0) {
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+  QSurfaceFormat surface_format = format();
+  surface_format.setVersion(3, 3);
+  surface_format.setProfile(QSurfaceFormat::CoreProfile);
+  setFormat(surface_format);
+
+  m_ptimer_ = new QTimer(this);
+  connect(m_ptimer_, &QTimer::timeout, this, &GlMazeView::NextStep);
+}
+
+GlMazeView::~GlMazeView() {
+  if (!m_words_texture_) return;
+  makeCurrent();
+  glDeleteTextures(1, &m_words_texture_);
+  glDeleteTextures(1, &m_cells_texture_);
+  m_vao_.destroy();
+  doneCurrent();
+}
+
+// The view needs integer textures and texelFetch, so a 3.3 core context is
+// tried once before any view is created.
+bool GlMazeView::Supported() {
+  QSurfaceFormat surface_format;
+  surface_format.setVersion(3, 3);
+  surface_format.setProfile(QSurfaceFormat::CoreProfile);
+  QOpenGLContext context;
+  context.setFormat(surface_format);
+  return context.create() && context.format().version() >= qMakePair(3, 3);
+}
+
+void GlMazeView::SetMaze(const Maze& maze) {
+  m_rows_ = maze.GetRows();
+  m_cols_ = maze.GetCols();
+  auto verticals = maze.GetVerticals();
+  auto horizontals = maze.GetHorizontals();
+  for (int i = 0; i < m_rows_; ++i) {
+    m_words_[4 * i] = static_cast<quint32>(verticals[i]);
+    m_words_[4 * i + 1] = static_cast<quint32>(verticals[i] >> 32);
+    m_words_[4 * i + 2] = static_cast<quint32>(horizontals[i]);
+    m_words_[4 * i + 3] = static_cast<quint32>(horizontals[i] >> 32);
+  }
+  ClearOverlay();
+}
+
+void GlMazeView::SetPath(std::vector<Cell> path) {
+  m_path_ = std::move(path);
+  ShowPath();
+}
+
+void GlMazeView::ShowPath() {
+  m_cells_.assign(2 * m_rows_ * m_cols_, 0);
+  m_heat_levels_ = 0;
+  m_path_length_ = m_path_.size();
+  for (int i = 0; i < m_path_length_; ++i) {
+    const Cell& cell = m_path_[i];
+    if (cell.r >= 0 && cell.c >= 0 && cell.r < m_rows_ && cell.c < m_cols_)
+      m_cells_[2 * (cell.r * m_cols_ + cell.c)] = i + 1;
+  }
+  StartAnimation(m_path_length_, 50);
+}
+
+void GlMazeView::SetHeat(const DistanceMap& levels) {
+  m_cells_.assign(2 * m_rows_ * m_cols_, 0);
+  m_path_length_ = 0;
+  m_heat_levels_ = levels.Levels();
+  for (const auto& cell : levels.cells)
+    m_cells_[2 * (cell.r * m_cols_ + cell.c) + 1] = levels.Distance(cell) + 1;
+  StartAnimation(m_heat_levels_, 30);
+}
+
+void GlMazeView::ClearOverlay() {
+  m_path_.clear();
+  m_cells_.assign(2 * m_rows_ * m_cols_, 0);
+  m_path_length_ = 0;
+  m_heat_levels_ = 0;
+  StartAnimation(0, 0);
+}
+
+void GlMazeView::StartAnimation(int steps, int interval_ms) {
+  m_ptimer_->stop();
+  m_visible_ = 0;
+  m_steps_ = steps;
+  m_dirty_ = true;
+  if (steps > 0) m_ptimer_->start(interval_ms);
+  update();
+}
+
+void GlMazeView::NextStep() {
+  if (++m_visible_ >= m_steps_) m_ptimer_->stop();
+  update();
+}
+
+void GlMazeView::initializeGL() {
+  initializeOpenGLFunctions();
+  m_program_.addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader);
+  m_program_.addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader);
+  if (!m_program_.link())
+    qWarning("GlMazeView: %s", qPrintable(m_program_.log()));
+  m_vao_.create();
+
+  glGenTextures(1, &m_words_texture_);
+  glGenTextures(1, &m_cells_texture_);
+  for (GLuint texture : {m_words_texture_, m_cells_texture_}) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  }
+  m_dirty_ = true;
+}
+
+void GlMazeView::UploadTextures() {
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glBindTexture(GL_TEXTURE_2D, m_words_texture_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, 2, m_rows_, 0, GL_RG_INTEGER,
+               GL_UNSIGNED_INT, m_words_.data());
+  glBindTexture(GL_TEXTURE_2D, m_cells_texture_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16UI, m_cols_, m_rows_, 0,
+               GL_RG_INTEGER, GL_UNSIGNED_SHORT, m_cells_.data());
+  m_dirty_ = false;
+}
+
+void GlMazeView::paintGL() {
+  QColor background = palette().color(QPalette::Window);
+  glClearColor(background.redF(), background.greenF(), background.blueF(),
+               1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  if (m_rows_ <= 0 || m_cols_ <= 0 || !m_program_.isLinked()) return;
+  if (m_dirty_) UploadTextures();
+
+  // Cell sizes follow the integer division of the raster widgets.
+  float ratio = devicePixelRatioF();
+  float cell_width = std::max(1, width() / m_cols_) * ratio;
+  float cell_height = std::max(1, height() / m_rows_) * ratio;
+
+  m_program_.bind();
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, m_words_texture_);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, m_cells_texture_);
+  m_program_.setUniformValue("u_words", 0);
+  m_program_.setUniformValue("u_cells", 1);
+  m_program_.setUniformValue("u_size", m_cols_, m_rows_);
+  m_program_.setUniformValue("u_cell_px", cell_width, cell_height);
+  m_program_.setUniformValue("u_height_px", height() * ratio);
+  m_program_.setUniformValue("u_wall_px", ratio);
+  m_program_.setUniformValue("u_mode", m_mode_ == Mode::kCave ? 1 : 0);
+  m_program_.setUniformValue("u_path_length", m_path_length_);
+  m_program_.setUniformValue("u_heat_levels", m_heat_levels_);
+  m_program_.setUniformValue("u_visible", m_visible_);
+
+  QOpenGLVertexArrayObject::Binder binder(&m_vao_);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  m_program_.release();
+}
@@ -0,0 +1,66 @@
+#ifndef GL_MAZE_VIEW_H_
+#define GL_MAZE_VIEW_H_
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWidget>
+#include <QTimer>
+#include <array>
+#include <vector>
+
+#include "../model/maze/maze.h"
+
+// Draws a maze or cave together with the path and distance heatmap in one
+// fragment shader. The packed wall words and per-cell overlay data are
+// uploaded as integer textures when they change; animating the path or the
+// heatmap only changes a uniform. MazeWidget and CaveWidget use it instead of
+// the QPainter views when the application is started with --gl and
+// Supported() holds.
+class GlMazeView : public QOpenGLWidget, protected QOpenGLFunctions {
+  Q_OBJECT
+ public:
+  enum class Mode { kMaze, kCave };
+
+  explicit GlMazeView(Mode mode, QWidget* parent = nullptr);
+  ~GlMazeView();
+
+  static bool Supported();
+  void SetMaze(const Maze& maze);
+  void SetPath(std::vector<Cell> path);
+  void ShowPath();
+  void SetHeat(const DistanceMap& levels);
+  void ClearOverlay();
+
+ protected:
+  void initializeGL() override;
+  void paintGL() override;
+
+ private slots:
+  void NextStep();
+
+ private:
+  void StartAnimation(int steps, int interval_ms);
+  void UploadTextures();
+
+  Mode m_mode_;
+  int m_rows_;
+  int m_cols_;
+  std::array<quint32, 4 * kMaxSize> m_words_;  // per row: v lo/hi, h lo/hi
+  std::vector<quint16> m_cells_;  // per cell: path index + 1, level + 1
+  std::vector<Cell> m_path_;      // kept to show again after a heatmap
+  int m_path_length_;
+  int m_heat_levels_;
+  int m_visible_;
+  int m_steps_;
+  bool m_dirty_;
+
+  QTimer* m_ptimer_;
+  QOpenGLShaderProgram m_program_;
+  QOpenGLVertexArrayObject m_vao_;
+  GLuint m_words_texture_;
+  GLuint m_cells_texture_;
+};
+
+#endif  // GL_MAZE_VIEW_H_
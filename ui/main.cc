@@ -5,7 +5,14 @@
 int main(int argc, char *argv[]) {
   QApplication app(argc, argv);
 
-  MazeWindow w;
+  // --gl draws through OpenGL when a 3.3 context is available; otherwise the
+  // QPainter views are used.
+  bool use_gl = app.arguments().contains("--gl");
+  if (use_gl && !GlMazeView::Supported()) {
+    qWarning("OpenGL 3.3 is not available, falling back to QPainter");
+    use_gl = false;
+  }
+  MazeWindow w(nullptr, use_gl);
   w.show();
 
   return app.exec();
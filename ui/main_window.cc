@@ -1,6 +1,7 @@
 #include "main_window.h"
 
-MazeWindow::MazeWindow(QWidget* parent) : QMainWindow(parent) {
+MazeWindow::MazeWindow(QWidget* parent, bool use_gl)
+    : QMainWindow(parent), m_use_gl_(use_gl) {
   setWindowTitle("MAZE PROJECT");
   setMinimumSize(670, 500);
   CreateMainMenu();
@@ -46,13 +47,13 @@ void MazeWindow::ShowMazeWidget(const char c) {
   QWidget* content = nullptr;
 
   if (c == 'm') {
-    MazeWidget* maze_widget = new MazeWidget(container);
+    MazeWidget* maze_widget = new MazeWidget(container, m_use_gl_);
     connect(maze_widget, &MazeWidget::BackRequested, this,
             &MazeWindow::CreateMainMenu);
     content = maze_widget;
 
   } else {
-    CaveWidget* cave_widget = new CaveWidget(container);
+    CaveWidget* cave_widget = new CaveWidget(container, m_use_gl_);
     connect(cave_widget, &CaveWidget::BackRequested, this,
             &MazeWindow::CreateMainMenu);
     content = cave_widget;
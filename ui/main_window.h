@@ -16,12 +16,14 @@ class MazeWindow : public QMainWindow {
   Q_OBJECT
 
  public:
-  explicit MazeWindow(QWidget* parent = nullptr);
+  explicit MazeWindow(QWidget* parent = nullptr, bool use_gl = false);
 
  private:
   void CreateMainMenu();
   void ShowMazeWidget(const char c);
   void AdjustButtonFonts(QPushButton* button);
+
+  bool m_use_gl_;
 };
 
 #endif
\ No newline at end of file
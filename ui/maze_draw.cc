@@ -1,5 +1,7 @@
 #include "maze_draw.h"
 
+#include <bit>
+
 MazeDrawWidget::MazeDrawWidget(Maze* maze, QWidget* parent)
     : QWidget(parent), m_pmaze_(maze) {
   setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -7,12 +9,27 @@ MazeDrawWidget::MazeDrawWidget(Maze* maze, QWidget* parent)
 
 void MazeDrawWidget::SetMaze(Maze* maze) {
   m_pmaze_ = maze;
+  m_walls_ = QPixmap();
   update();
 }
 
+void MazeDrawWidget::resizeEvent(QResizeEvent*) { m_walls_ = QPixmap(); }
+
+// The walls only change with SetMaze or a resize, while the path overlay
+// repaints this widget on every animation step; those repaints only blit.
 void MazeDrawWidget::paintEvent(QPaintEvent*) {
   if (!m_pmaze_) return;
+  if (m_walls_.isNull()) RenderWalls();
   QPainter painter(this);
+  painter.drawPixmap(0, 0, m_walls_);
+}
+
+void MazeDrawWidget::RenderWalls() {
+  qreal ratio = devicePixelRatioF();
+  m_walls_ = QPixmap(size() * ratio);
+  m_walls_.setDevicePixelRatio(ratio);
+  m_walls_.fill(Qt::transparent);
+  QPainter painter(&m_walls_);
 
   int rows = m_pmaze_->GetRows();
   int cols = m_pmaze_->GetCols();
@@ -28,24 +45,47 @@ void MazeDrawWidget::paintEvent(QPaintEvent*) {
   painter.setPen(pen);
   painter.setBrush(Qt::NoBrush);
 
-  auto vWalls = m_pmaze_->GetVerticals();
-  auto hWalls = m_pmaze_->GetHorizontals();
+  m_lines_.clear();
+  AppendVerticalRuns(rows, cols, cell_width, cell_height);
+  AppendHorizontalRuns(rows, cols, cell_width, cell_height);
+  painter.drawLines(m_lines_);
+}
 
-  for (int i = 0; i < rows; i++) {
-    for (int j = 0; j < cols - 1; j++) {
-      if (m_pmaze_->GetBit(vWalls[i], j)) {
-        int x = (j + 1) * cell_width;
-        painter.drawLine(x, i * cell_height, x, (i + 1) * cell_height);
-      }
+// A vertical wall continues while the same bit stays set in the next row, so
+// runs are tracked per column: bits that switch on open a run, bits that
+// switch off close it.
+void MazeDrawWidget::AppendVerticalRuns(int rows, int cols, int cell_width,
+                                        int cell_height) {
+  auto walls = m_pmaze_->GetVerticals();
+  uint64_t mask = (uint64_t{1} << (cols - 1)) - 1;
+  std::array<int, kMaxSize> run_start{};
+  uint64_t open = 0;
+  for (int i = 0; i <= rows; ++i) {
+    uint64_t row = i < rows ? walls[i] & mask : 0;
+    for (uint64_t ended = open & ~row; ended; ended &= ended - 1) {
+      int j = std::countr_zero(ended);
+      int x = (j + 1) * cell_width;
+      m_lines_.append(QLine(x, run_start[j] * cell_height, x, i * cell_height));
     }
+    for (uint64_t started = row & ~open; started; started &= started - 1)
+      run_start[std::countr_zero(started)] = i;
+    open = row;
   }
+}
 
-  for (int i = 0; i < rows - 1; i++) {
-    for (int j = 0; j < cols; j++) {
-      if (m_pmaze_->GetBit(hWalls[i], j)) {
-        int y = (i + 1) * cell_height;
-        painter.drawLine(j * cell_width, y, (j + 1) * cell_width, y);
-      }
+void MazeDrawWidget::AppendHorizontalRuns(int rows, int cols, int cell_width,
+                                          int cell_height) {
+  auto walls = m_pmaze_->GetHorizontals();
+  uint64_t mask = (uint64_t{1} << cols) - 1;
+  for (int i = 0; i < rows - 1; ++i) {
+    int y = (i + 1) * cell_height;
+    uint64_t row = walls[i] & mask;
+    while (row) {
+      int first = std::countr_zero(row);
+      int length = std::countr_one(row >> first);
+      m_lines_.append(
+          QLine(first * cell_width, y, (first + length) * cell_width, y));
+      row &= ~(((uint64_t{1} << length) - 1) << first);
     }
   }
 }
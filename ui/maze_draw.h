@@ -2,6 +2,9 @@
 #define DRAW_MAZE_H_
 
 #include <QPainter>
+#include <QLine>
+#include <QPixmap>
+#include <QVector>
 #include <QWidget>
 
 #include "../model/maze/maze.h"
@@ -14,9 +17,17 @@ class MazeDrawWidget : public QWidget {
 
  protected:
   void paintEvent(QPaintEvent*) override;
+  void resizeEvent(QResizeEvent*) override;
 
  private:
+  void RenderWalls();
+  void AppendVerticalRuns(int rows, int cols, int cell_width, int cell_height);
+  void AppendHorizontalRuns(int rows, int cols, int cell_width,
+                            int cell_height);
+
   Maze* m_pmaze_;
+  QPixmap m_walls_;         // rasterized walls, null when stale
+  QVector<QLine> m_lines_;  // merged wall segments, reused between renders
 };
 
-#endif  // DRAW_MAZE_H_
\ No newline at end of file
+#endif  // DRAW_MAZE_H_
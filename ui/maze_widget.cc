@@ -1,7 +1,13 @@
 
 #include "maze_widget.h"
 
-MazeWidget::MazeWidget(QWidget* parent) : QWidget(parent), m_pagent_() {
+MazeWidget::MazeWidget(QWidget* parent, bool use_gl)
+    : QWidget(parent),
+      m_pagent_(),
+      m_pmaze_view_(),
+      m_ppath_view_(),
+      m_pbonus_view_(),
+      m_pgl_view_() {
   Maze::InitRandom();
   m_pmaze_ = new Maze(10, 10);
   m_pmaze_->GenerateMaze();
@@ -10,7 +16,7 @@ MazeWidget::MazeWidget(QWidget* parent) : QWidget(parent), m_pagent_() {
   main_layout->setContentsMargins(0, 0, 0, 0);
   main_layout->setSpacing(0);
 
-  main_layout->addWidget(MazeDrawing());
+  main_layout->addWidget(MazeDrawing(use_gl));
   main_layout->insertWidget(0, CreateSideMenu());
   main_layout->setAlignment(Qt::AlignTop);
   setLayout(main_layout);
@@ -72,10 +78,8 @@ QHBoxLayout* MazeWidget::CreateButtonsLayout() {
   connect(back_btn, &QPushButton::clicked, this, &MazeWidget::BackRequested);
   connect(load_btn, &QPushButton::clicked, this, [this]() {
     if (MazeFileLoader::LoadMazeFromFile(this, m_pmaze_, 'm')) {
+      ShowMaze();
       emit MazeSizeChanged();
-      m_pmaze_view_->SetMaze(m_pmaze_);
-      m_pbonus_view_->hide();
-      m_ppath_view_->show();
     }
   });
   connect(save_btn, &QPushButton::clicked, this,
@@ -84,7 +88,13 @@ QHBoxLayout* MazeWidget::CreateButtonsLayout() {
   return button_layout;
 }
 
-QWidget* MazeWidget::MazeDrawing() {
+QWidget* MazeWidget::MazeDrawing(bool use_gl) {
+  if (use_gl) {
+    m_pgl_view_ = new GlMazeView(GlMazeView::Mode::kMaze, this);
+    m_pgl_view_->SetMaze(*m_pmaze_);
+    return m_pgl_view_;
+  }
+
   QWidget* drawing_container = new QWidget(this);
   QGridLayout* layout = new QGridLayout(drawing_container);
   layout->setContentsMargins(0, 0, 0, 0);
@@ -102,6 +112,46 @@ QWidget* MazeWidget::MazeDrawing() {
   return drawing_container;
 }
 
+// The GL view draws the maze and its overlay in one widget; the QPainter
+// fallback stacks a view per layer and switches between path and heatmap.
+void MazeWidget::ShowMaze() {
+  if (m_pgl_view_) {
+    m_pgl_view_->SetMaze(*m_pmaze_);
+    return;
+  }
+  m_pmaze_view_->SetMaze(m_pmaze_);
+  m_pbonus_view_->hide();
+  m_ppath_view_->show();
+}
+
+void MazeWidget::ShowPath(std::vector<Cell>&& path) {
+  if (m_pgl_view_) {
+    m_pgl_view_->SetPath(std::move(path));
+  } else {
+    m_ppath_view_->SetSolution(std::move(path), m_pmaze_->GetRows(),
+                               m_pmaze_->GetCols());
+  }
+}
+
+void MazeWidget::ShowHeat(DistanceMap&& levels) {
+  if (m_pgl_view_) {
+    m_pgl_view_->SetHeat(levels);
+    return;
+  }
+  m_ppath_view_->hide();
+  m_pbonus_view_->show();
+  m_pbonus_view_->SetSolution(std::move(levels));
+}
+
+void MazeWidget::HideHeat() {
+  if (m_pgl_view_) {
+    m_pgl_view_->ShowPath();
+    return;
+  }
+  m_pbonus_view_->hide();
+  m_ppath_view_->show();
+}
+
 QVBoxLayout* MazeWidget::CreateSpinBox(QSpinBox* spinbox,
                                        const QString& label_text,
                                        QWidget* parent) {
@@ -136,11 +186,9 @@ QVBoxLayout* MazeWidget::CreateGenerateLayout() {
   connect(generate, &QPushButton::clicked, this, [this, rows, cols]() {
     m_pmaze_->SetRowsCols(rows->value(), cols->value());
     m_pmaze_->GenerateMaze();
-    emit MazeSizeChanged();
-    m_pmaze_view_->SetMaze(m_pmaze_);
+    ShowMaze();
     // emit SecretBackPressed();
-    m_pbonus_view_->hide();
-    m_ppath_view_->show();
+    emit MazeSizeChanged();
   });
   connect(this, &MazeWidget::MazeSizeChanged, this, [this, rows, cols]() {
     rows->setValue(m_pmaze_->GetRows());
@@ -180,18 +228,11 @@ QWidget* MazeWidget::CreateSecretWidget(QWidget* menu) {
   connect(this, &MazeWidget::MazeSizeChanged, secret_col,
           [this, secret_col]() { SetSpinboxValues(secret_col, 'c'); });
   connect(run, &QPushButton::clicked, this, [this, secret_row, secret_col] {
-    m_ppath_view_->hide();
-    m_pbonus_view_->show();
-    m_pbonus_view_->SetSolution(
-        m_pmaze_->DistanceMatrix(
-            {secret_row->value() - 1, secret_col->value() - 1}),
-        m_pmaze_->GetRows(), m_pmaze_->GetCols());
+    ShowHeat(m_pmaze_->DistanceMatrix(
+        {secret_row->value() - 1, secret_col->value() - 1}));
   });
   connect(back, &QPushButton::clicked, this, [this]() {
-    if (m_pbonus_view_) {
-      m_pbonus_view_->hide();
-    }
-    m_ppath_view_->show();
+    HideHeat();
     emit SecretBackPressed();
   });
   return secret_widget;
@@ -263,10 +304,9 @@ QWidget* MazeWidget::CreateSolveTab(QWidget* menu) {
           [this, target_row, target_col, start_row, start_col]() {
             Cell target = {target_row->value() - 1, target_col->value() - 1};
             Cell start = {start_row->value() - 1, start_col->value() - 1};
-            m_solution_ = m_pmaze_->SolveMaze(start, target);
-            if (!m_solution_.empty()) {
-              m_ppath_view_->SetSolution(m_solution_, m_pmaze_->GetRows(),
-                                         m_pmaze_->GetCols());
+            auto solution = m_pmaze_->SolveMaze(start, target);
+            if (!solution.empty()) {
+              ShowPath(std::move(solution));
             } else {
               QMessageBox::information(this, "Sorry", "Can't find path.");
             }
@@ -309,18 +349,11 @@ void MazeWidget::ConnectSolveTabSpins(QSpinBox* target_row,
 }
 
 void MazeWidget::UpdateSolution(const Cell& cell) {
-  m_solution_.clear();
-  m_solution_.push_back((Cell){cell.r - 1, cell.c - 1});
-  m_ppath_view_->SetSolution(m_solution_, m_pmaze_->GetRows(),
-                             m_pmaze_->GetCols());
+  ShowPath({{cell.r - 1, cell.c - 1}});
 }
 
 void MazeWidget::UpdateSolution(const Cell& cell1, const Cell& cell2) {
-  m_solution_.clear();
-  m_solution_.push_back((Cell){cell1.r - 1, cell1.c - 1});
-  m_solution_.push_back((Cell){cell2.r - 1, cell2.c - 1});
-  m_ppath_view_->SetSolution(m_solution_, m_pmaze_->GetRows(),
-                             m_pmaze_->GetCols());
+  ShowPath({{cell1.r - 1, cell1.c - 1}, {cell2.r - 1, cell2.c - 1}});
 }
 
 void MazeWidget::StartTraining(QSpinBox* target_row, QSpinBox* target_col) {
@@ -504,11 +537,10 @@ void MazeWidget::ConnectQLearnWidgets(
 }
 
 void MazeWidget::ShowAgentPath(QSpinBox* start_row, QSpinBox* start_col) {
-  m_solution_ =
+  auto solution =
       m_pagent_->FindPath({start_row->value() - 1, start_col->value() - 1});
-  if (!m_solution_.empty()) {
-    m_ppath_view_->SetSolution(m_solution_, m_pmaze_->GetRows(),
-                               m_pmaze_->GetCols());
+  if (!solution.empty()) {
+    ShowPath(std::move(solution));
   } else {
     QMessageBox::information(this, "Sorry", "Can't find path.");
   }
@@ -17,6 +17,7 @@
 #include "../model/maze/maze.h"
 #include "../model/q_learning/q_learning.h"
 #include "bonus_draw.h"
+#include "gl_maze_view.h"
 #include "loader.h"
 #include "maze_draw.h"
 #include "maze_style.h"
@@ -27,7 +28,7 @@ class MazeWidget : public QWidget {
   Q_OBJECT
 
  public:
-  explicit MazeWidget(QWidget* parent = nullptr);
+  explicit MazeWidget(QWidget* parent = nullptr, bool use_gl = false);
 
  signals:
   void BackRequested();
@@ -43,12 +44,16 @@ class MazeWidget : public QWidget {
   MazeDrawWidget* m_pmaze_view_;
   PathDrawWidget* m_ppath_view_;
   BonusDrawWidget* m_pbonus_view_;
-  std::vector<Cell> m_solution_;
+  GlMazeView* m_pgl_view_;  // replaces the three views above when set
 
   QWidget* CreateSideMenu();
   QWidget* CreateSolveTab(QWidget* menu);
   QWidget* CreateQLearnTab(QWidget* menu);
-  QWidget* MazeDrawing();
+  QWidget* MazeDrawing(bool use_gl);
+  void ShowMaze();
+  void ShowPath(std::vector<Cell>&& path);
+  void ShowHeat(DistanceMap&& levels);
+  void HideHeat();
   void UpdateSolution(const Cell& cell);
   void UpdateSolution(const Cell& cell1, const Cell& cell2);
   QHBoxLayout* CreateButtonsLayout();
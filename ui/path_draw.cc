@@ -7,11 +7,11 @@ PathDrawWidget::PathDrawWidget(int rows, int cols, QWidget* parent)
   m_current_step_ = 0;
 }
 
-void PathDrawWidget::SetSolution(const std::vector<Cell>& solution, int rows,
+void PathDrawWidget::SetSolution(std::vector<Cell>&& solution, int rows,
                                  int cols) {
   m_rows_ = rows;
   m_cols_ = cols;
-  m_solution_ = solution;
+  m_solution_ = std::move(solution);
   m_current_step_ = 0;
   update();
   if (!m_solution_.empty())
@@ -11,7 +11,7 @@ class PathDrawWidget : public QWidget {
   Q_OBJECT
  public:
   PathDrawWidget(int rows, int cols, QWidget* parent = nullptr);
-  void SetSolution(const std::vector<Cell>& solution, int rows, int cols);
+  void SetSolution(std::vector<Cell>&& solution, int rows, int cols);
 
  protected:
   void paintEvent(QPaintEvent*) override;